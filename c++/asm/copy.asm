@@ -0,0 +1,7 @@
+	LW	R1 0(R0)
+	SW	R1 32(R0)
+	LW	R2 4(R0)
+	SW	R2 36(R0)
+	ADD	R3 R1 R2
+	SW	R3 40(R0)
+	EOP
@@ -0,0 +1,4 @@
+	DIVS	F1 F2 F3
+	DIVS	F4 F5 F6
+	DIVS	F7 F8 F9
+	EOP
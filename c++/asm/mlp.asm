@@ -0,0 +1,15 @@
+	XOR	R0 R0 R0
+	ADDI	R1 R0 0xA000
+	LWS	F1 0(R1)
+	LWS	F2 4(R1)
+	LWS	F3 64(R1)
+	LWS	F4 128(R1)
+	LWS	F5 192(R1)
+	LWS	F6 196(R1)
+	ADDS	F7 F1 F2
+	ADDS	F8 F3 F4
+	ADDS	F9 F5 F6
+	ADDS	F7 F7 F8
+	ADDS	F7 F7 F9
+	SWS	F7 256(R1)
+	EOP
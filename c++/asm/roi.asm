@@ -0,0 +1,19 @@
+	XOR	R0 R0 R0
+	ADDI	R2 R0 0xA000
+	ADDI	R4 R0 8
+INIT:	SW	R4 0(R2)
+	ADDI	R2 R2 4
+	SUBI	R4 R4 1
+	BNEZ	R4 INIT
+	.roi_begin
+	XOR	R1 R1 R1
+	ADDI	R2 R0 0xA000
+	ADDI	R4 R0 8
+SUM:	LW	R3 0(R2)
+	ADD	R1 R1 R3
+	ADDI	R2 R2 4
+	SUBI	R4 R4 1
+	BNEZ	R4 SUM
+	.roi_end
+	SW	R1 0(R2)
+	EOP
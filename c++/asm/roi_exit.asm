@@ -0,0 +1,7 @@
+	XOR	R0 R0 R0
+	.roi_begin
+	ADDI	R1 R0 1
+	BNEZ	R1 DONE
+	.roi_end
+	ADDI	R2 R0 2
+DONE:	EOP
@@ -0,0 +1,3 @@
+ADDI	R1 R0 5
+ADD	R2 R1 R1
+EOP
@@ -0,0 +1,11 @@
+	XOR	R0 R0 R0
+	XOR	R1 R1 R1
+	ADDI	R2 R0 0xA000
+	ADDI	R4 R0 16
+LOOP:	LW	R3 0(R2)
+	ADD	R1 R1 R3
+	ADDI	R2 R2 32
+	SUBI	R4 R4 1
+	BNEZ	R4 LOOP
+	SW	R1 0(R2)
+	EOP
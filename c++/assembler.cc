@@ -0,0 +1,18 @@
+#include "program.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Pre-assembles an assembly program into a binary program image, which the simulators load with "load_binary" */
+/* The whole instruction set is accepted (see opcode_t): images of integer programs can be loaded by both simulators */
+
+int main(int argc, char **argv){
+
+	if (argc != 3){
+		cerr << "usage: " << argv[0] << " <program.asm> <program.bin>" << endl;
+		exit(-1);
+	}
+
+	write_program_image(*parse_program(argv[1], NUM_ISA_OPCODES), argv[2]);
+}
@@ -0,0 +1,71 @@
+#include "branch_predictor.h"
+#include <algorithm>
+
+/* returns true if "n" is a (non-zero) power of 2 */
+static inline bool is_power_of_2(unsigned n){
+	return n != 0 && (n & (n-1)) == 0;
+}
+
+/* instantiates a disabled predictor */
+branch_predictor::branch_predictor(){
+	enabled = false;
+	type = PREDICT_NOT_TAKEN;
+	history_bits = 0;
+	reset();
+}
+
+/* configures (and empties) the predictor */
+bool branch_predictor::configure(predictor_t predictor, unsigned table_size, unsigned bits, unsigned btb_size){
+	if (predictor != PREDICT_NOT_TAKEN && !is_power_of_2(table_size)) return false;
+	if (predictor == PREDICT_GSHARE && (bits > MAX_HISTORY_BITS || (1u << bits) > table_size)) return false;
+	if (btb_size != 0 && !is_power_of_2(btb_size)) return false;
+	enabled = true;
+	type = predictor;
+	history_bits = (predictor == PREDICT_GSHARE) ? bits : 0;
+	counters.assign(predictor == PREDICT_NOT_TAKEN ? 0 : table_size, 0);
+	btb.resize(btb_size);
+	reset();
+	return true;
+}
+
+/* empties the predictor and clears the statistics */
+void branch_predictor::reset(){
+	fill(counters.begin(), counters.end(), 1); //weakly not taken
+	history = 0;
+	for (unsigned e=0; e<btb.size(); e++){
+		btb[e].pc = 0xFFFFFFFF;
+		btb[e].target = 0;
+	}
+	stats.branches = 0;
+	stats.mispredictions = 0;
+	stats.btb_misses = 0;
+}
+
+/* returns the predicted next PC of a branch */
+unsigned branch_predictor::predict(unsigned pc, unsigned target, bool unconditional){
+	bool taken = unconditional || (type != PREDICT_NOT_TAKEN && counter(pc) >= 2);
+	if (!taken) return pc + 4;
+	if (btb.empty()) return target;
+	const btb_entry_t &entry = btb[(pc >> 2) & (btb.size()-1)];
+	return (entry.pc == pc) ? entry.target : pc + 4;
+}
+
+/* updates the predictor with a resolved branch */
+bool branch_predictor::update(unsigned pc, bool taken, unsigned target, bool unconditional, unsigned predicted_pc){
+	stats.branches++;
+	if (!unconditional && type != PREDICT_NOT_TAKEN){
+		unsigned char &c = counter(pc);
+		if (taken && c < 3) c++;
+		if (!taken && c > 0) c--;
+		if (type == PREDICT_GSHARE) history = ((history << 1) | taken) & ((1u << history_bits) - 1);
+	}
+	if (taken && !btb.empty()){
+		btb_entry_t &entry = btb[(pc >> 2) & (btb.size()-1)];
+		if (entry.pc != pc || entry.target != target) stats.btb_misses++;
+		entry.pc = pc;
+		entry.target = target;
+	}
+	bool mispredicted = predicted_pc != (taken ? target : pc + 4);
+	if (mispredicted) stats.mispredictions++;
+	return mispredicted;
+}
@@ -0,0 +1,97 @@
+#ifndef BRANCH_PREDICTOR_H_
+#define BRANCH_PREDICTOR_H_
+
+#include <vector>
+
+using namespace std;
+
+/*
+Dynamic branch predictor, used in IF to guess the next PC before the branch is resolved.
+
+Direction predictors:
+- PREDICT_NOT_TAKEN: static, every conditional branch is predicted not taken
+- PREDICT_BIMODAL: table of 2-bit saturating counters indexed by the PC of the branch
+- PREDICT_GSHARE: table of 2-bit saturating counters indexed by the PC of the branch XOR the global history
+  of the last "history_bits" conditional branches (updated when the branches are resolved)
+Unconditional jumps are always predicted taken.
+
+Branch target buffer (BTB): a direct-mapped table, indexed by PC, of the targets of the taken branches.
+With a BTB, a branch predicted taken redirects the fetch only if its target is in the BTB (otherwise the
+fetch continues sequentially). Without a BTB, the target is assumed to be known at fetch time (the
+instructions are pre-decoded, see instruction_t).
+*/
+
+typedef enum {PREDICT_NOT_TAKEN, PREDICT_BIMODAL, PREDICT_GSHARE} predictor_t;
+
+#define MAX_HISTORY_BITS 16 //maximum length of the global history of gshare
+
+//branch target buffer entry
+typedef struct{
+	unsigned pc; //PC of the branch (0xFFFFFFFF if the entry is empty)
+	unsigned target; //target of the branch
+} btb_entry_t;
+
+//statistics of the branch predictor
+typedef struct{
+	unsigned branches; //branches resolved
+	unsigned mispredictions; //branches whose predicted next PC was wrong
+	unsigned btb_misses; //taken branches whose target was not in the BTB
+} branch_stats_t;
+
+class branch_predictor{
+
+	//configuration
+	bool enabled;
+	predictor_t type;
+	unsigned history_bits;
+
+	//2-bit saturating counters (a branch is predicted taken if its counter is at least 2)
+	vector<unsigned char> counters;
+
+	//global history of the conditional branches (gshare), most recent in the least significant bit
+	unsigned history;
+
+	//branch target buffer (empty if not configured)
+	vector<btb_entry_t> btb;
+
+	//statistics
+	branch_stats_t stats;
+
+	//returns the counter used by the branch at "pc"
+	inline unsigned char &counter(unsigned pc){
+		unsigned index = pc >> 2;
+		if (type == PREDICT_GSHARE) index ^= history;
+		return counters[index & (counters.size()-1)];
+	}
+
+public:
+
+	//instantiates a disabled predictor
+	branch_predictor();
+
+	//configures (and empties) the predictor
+	//- table_size: number of 2-bit counters (power of 2 - ignored by PREDICT_NOT_TAKEN)
+	//- history_bits: length of the global history (PREDICT_GSHARE only - at most MAX_HISTORY_BITS and log2(table_size))
+	//- btb_size: number of BTB entries (power of 2 - 0: no BTB)
+	//returns false if the configuration is not valid
+	bool configure(predictor_t type, unsigned table_size, unsigned history_bits, unsigned btb_size);
+
+	//returns true if the predictor has been configured
+	inline bool is_enabled(){ return enabled; }
+
+	//returns the predicted next PC of the branch at "pc", with the given target (a conditional branch unless "unconditional")
+	//the state of the predictor is not updated
+	unsigned predict(unsigned pc, unsigned target, bool unconditional);
+
+	//updates the predictor with a resolved branch, which had been predicted to continue at "predicted_pc"
+	//returns true if the branch was mispredicted
+	bool update(unsigned pc, bool taken, unsigned target, bool unconditional, unsigned predicted_pc);
+
+	//empties the predictor and clears the statistics (the configuration is preserved)
+	void reset();
+
+	//returns the statistics
+	inline const branch_stats_t &get_stats(){ return stats; }
+};
+
+#endif /*BRANCH_PREDICTOR_H_*/
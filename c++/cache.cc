@@ -0,0 +1,127 @@
+#include "cache.h"
+#include <algorithm>
+
+/* returns true if "n" is a (non-zero) power of 2 */
+static inline bool is_power_of_2(unsigned n){
+	return n != 0 && (n & (n-1)) == 0;
+}
+
+/* instantiates a disabled cache */
+cache::cache(){
+	size = 0;
+	associativity = 0;
+	line_size = 0;
+	hit_latency = 0;
+	replacement = REPL_LRU;
+	write_policy = WRITE_BACK;
+	line_bits = 0;
+	num_sets = 0;
+	invalidate();
+}
+
+/* configures (and empties) the cache */
+bool cache::configure(unsigned cache_size, unsigned ways, unsigned line, unsigned latency, replacement_policy_t repl, write_policy_t policy){
+	if (!is_power_of_2(cache_size) || !is_power_of_2(line) || line < 4 || line > cache_size || ways == 0 || (cache_size/line) % ways != 0 || !is_power_of_2(cache_size/line/ways)) return false;
+	size = cache_size;
+	associativity = ways;
+	line_size = line;
+	hit_latency = latency;
+	replacement = repl;
+	write_policy = policy;
+	for (line_bits=0; (1u << line_bits) < line_size; line_bits++);
+	num_sets = size / line_size / associativity;
+	tags.assign(num_sets*associativity, INVALID_LINE);
+	stamps.assign(num_sets*associativity, 0);
+	dirty.assign(num_sets*associativity, 0);
+	prefetched.assign(num_sets*associativity, 0);
+	invalidate();
+	return true;
+}
+
+/* empties the cache and clears the statistics */
+void cache::invalidate(){
+	fill(tags.begin(), tags.end(), INVALID_LINE);
+	fill(stamps.begin(), stamps.end(), 0);
+	fill(dirty.begin(), dirty.end(), 0);
+	fill(prefetched.begin(), prefetched.end(), 0);
+	time = 0;
+	random_state = 0x12345678; //fixed seed, so that the simulations are reproducible
+	stats.hits = 0;
+	stats.misses = 0;
+	stats.evictions = 0;
+	stats.writebacks = 0;
+	stats.prefetch_hits = 0;
+	stats.unused_prefetches = 0;
+}
+
+/* returns the way of "set" to be replaced */
+unsigned cache::victim_way(unsigned set){
+	unsigned base = set*associativity;
+	int way = find_way(set, INVALID_LINE);
+	if (way >= 0) return way;
+	if (replacement == REPL_RANDOM){
+		random_state ^= random_state << 13;
+		random_state ^= random_state >> 17;
+		random_state ^= random_state << 5;
+		return random_state % associativity;
+	}
+	// LRU and FIFO: oldest stamp (last access for LRU, fill for FIFO)
+	unsigned victim = 0;
+	for (unsigned w=1; w<associativity; w++)
+		if (time - stamps[base+w] > time - stamps[base+victim]) victim = w; //age, robust to the wrap-around of "time"
+	return victim;
+}
+
+/* replaces the victim line of the set of "tag" with line "tag" */
+unsigned cache::allocate(unsigned tag, unsigned &writeback){
+	unsigned set = tag & (num_sets-1);
+	unsigned entry = set*associativity + victim_way(set);
+	if (tags[entry] != INVALID_LINE){
+		stats.evictions++;
+		if (prefetched[entry]) stats.unused_prefetches++;
+		if (dirty[entry]){
+			stats.writebacks++;
+			writeback = tags[entry] << line_bits;
+		}
+	}
+	tags[entry] = tag;
+	stamps[entry] = time;
+	dirty[entry] = 0;
+	prefetched[entry] = 0;
+	return entry;
+}
+
+/* accesses the cache */
+bool cache::access(unsigned address, bool is_write, unsigned &writeback){
+	writeback = INVALID_LINE;
+	unsigned tag = address >> line_bits;
+	unsigned set = tag & (num_sets-1);
+	time++;
+	int way = find_way(set, tag);
+	if (way >= 0){
+		stats.hits++;
+		unsigned entry = set*associativity + way;
+		if (replacement == REPL_LRU) stamps[entry] = time;
+		if (is_write && write_policy == WRITE_BACK) dirty[entry] = 1;
+		if (prefetched[entry]){
+			stats.prefetch_hits++;
+			prefetched[entry] = 0;
+		}
+		return true;
+	}
+	stats.misses++;
+	if (is_write && write_policy == WRITE_THROUGH) return false; //no-write-allocate
+	unsigned entry = allocate(tag, writeback);
+	dirty[entry] = (is_write && write_policy == WRITE_BACK);
+	return false;
+}
+
+/* brings the line containing "address" into the cache, if not already there */
+bool cache::prefetch(unsigned address, unsigned &writeback){
+	writeback = INVALID_LINE;
+	unsigned tag = address >> line_bits;
+	if (find_way(tag & (num_sets-1), tag) >= 0) return false;
+	time++;
+	prefetched[allocate(tag, writeback)] = 1;
+	return true;
+}
@@ -0,0 +1,124 @@
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <vector>
+
+using namespace std;
+
+/*
+Set-associative cache (timing model only: the data is always kept in the data memory).
+The cache keeps, for each line, its tag (line address), a replacement stamp and a dirty bit.
+Each of these fields is stored in its own array, in which the ways of a set are contiguous,
+so that a lookup is a single compare loop over "associativity" consecutive tags.
+
+Write policies:
+- WRITE_BACK: write-allocate; dirty lines are written to the next level when evicted
+- WRITE_THROUGH: no-write-allocate; every write is also sent to the next level
+*/
+
+typedef enum {REPL_LRU, REPL_FIFO, REPL_RANDOM} replacement_policy_t;
+
+typedef enum {WRITE_BACK, WRITE_THROUGH} write_policy_t;
+
+#define INVALID_LINE 0xFFFFFFFF //tag of an empty line (never a valid line address)
+
+//cache statistics
+typedef struct{
+	unsigned hits; //accesses which found the line in the cache
+	unsigned misses; //accesses which did not find the line in the cache
+	unsigned evictions; //valid lines replaced to make room for a new one
+	unsigned writebacks; //dirty lines written to the next level when evicted
+	unsigned prefetch_hits; //first demand hits on prefetched lines
+	unsigned unused_prefetches; //prefetched lines evicted before any demand access
+} cache_stats_t;
+
+class cache{
+
+	//configuration
+	unsigned size; //size in bytes (0 if the cache is disabled)
+	unsigned associativity; //number of ways
+	unsigned line_size; //line size in bytes
+	unsigned hit_latency; //hit latency in clock cycles
+	replacement_policy_t replacement;
+	write_policy_t write_policy;
+
+	unsigned line_bits; //log2(line_size)
+	unsigned num_sets; //number of sets (a power of 2)
+
+	//line fields, stored set by set (set s occupies entries [s*associativity, (s+1)*associativity))
+	vector<unsigned> tags; //line address (address >> line_bits), INVALID_LINE if empty
+	vector<unsigned> stamps; //LRU: time of the last access - FIFO: time of the fill
+	vector<unsigned char> dirty; //line modified and not yet written to the next level
+	vector<unsigned char> prefetched; //line brought in by a prefetch, and not yet accessed by a demand access
+
+	//time (number of accesses) used for the replacement stamps
+	unsigned time;
+
+	//state of the pseudo-random generator used by REPL_RANDOM (xorshift)
+	unsigned random_state;
+
+	//statistics
+	cache_stats_t stats;
+
+	//returns the way of "set" holding line "tag" (-1 if none)
+	inline int find_way(unsigned set, unsigned tag){
+		const unsigned *set_tags = &tags[set*associativity];
+		int way = -1;
+		for (unsigned w=0; w<associativity; w++)
+			if (set_tags[w] == tag) way = w;
+		return way;
+	}
+
+	//returns the way of "set" to be replaced (an empty one, if any)
+	unsigned victim_way(unsigned set);
+
+	//replaces the victim line of the set of "tag" with line "tag" - returns the entry, and the address of the evicted line in "writeback" if dirty
+	unsigned allocate(unsigned tag, unsigned &writeback);
+
+public:
+
+	//instantiates a disabled cache
+	cache();
+
+	//configures (and empties) the cache - size and line_size in bytes, hit_latency in clock cycles
+	//returns false if the configuration is not valid (size and line_size must be powers of 2, line_size at least a word, and the number of sets must be a power of 2)
+	bool configure(unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency, replacement_policy_t replacement, write_policy_t write_policy);
+
+	//returns true if the cache has been configured
+	inline bool is_enabled(){ return size != 0; }
+
+	//returns true if the line containing "address" is in the cache (without updating the cache state or the statistics)
+	inline bool probe(unsigned address){ return find_way((address >> line_bits) & (num_sets-1), address >> line_bits) >= 0; }
+
+	//returns true if the line containing "address" is in the cache, and was prefetched but not yet accessed by a demand access
+	inline bool is_prefetched(unsigned address){
+		unsigned tag = address >> line_bits;
+		int way = find_way(tag & (num_sets-1), tag);
+		return way >= 0 && prefetched[(tag & (num_sets-1))*associativity + way];
+	}
+
+	//accesses the cache, allocating the line on a miss (except for writes to a write-through cache)
+	//returns true on a hit - if a dirty line is evicted, its address is returned in "writeback" (INVALID_LINE otherwise)
+	bool access(unsigned address, bool is_write, unsigned &writeback);
+
+	//brings the line containing "address" into the cache, if not already there (without updating the hit/miss statistics)
+	//returns true if the line has been brought in - if a dirty line is evicted, its address is returned in "writeback" (INVALID_LINE otherwise)
+	bool prefetch(unsigned address, unsigned &writeback);
+
+	//empties the cache and clears the statistics (the configuration is preserved)
+	void invalidate();
+
+	//returns the hit latency (in clock cycles)
+	inline unsigned get_hit_latency(){ return hit_latency; }
+
+	//returns the write policy
+	inline write_policy_t get_write_policy(){ return write_policy; }
+
+	//returns the line size (in bytes)
+	inline unsigned get_line_size(){ return line_size; }
+
+	//returns the statistics
+	inline const cache_stats_t &get_stats(){ return stats; }
+};
+
+#endif /*CACHE_H_*/
@@ -0,0 +1,38 @@
+#include "dram.h"
+#include <algorithm>
+
+/* returns true if "n" is a (non-zero) power of 2 */
+static inline bool is_power_of_2(unsigned n){
+	return n != 0 && (n & (n-1)) == 0;
+}
+
+/* instantiates a disabled DRAM model */
+dram::dram(){
+	num_banks = 0;
+	row_bits = 0;
+	row_hit_latency = 0;
+	row_miss_latency = 0;
+	row_conflict_latency = 0;
+	reset();
+}
+
+/* configures the DRAM model */
+bool dram::configure(unsigned banks, unsigned row_size, unsigned hit_latency, unsigned miss_latency, unsigned conflict_latency){
+	if (!is_power_of_2(banks) || !is_power_of_2(row_size) || row_size < 4) return false;
+	num_banks = banks;
+	for (row_bits=0; (1u << row_bits) < row_size; row_bits++);
+	row_hit_latency = hit_latency;
+	row_miss_latency = miss_latency;
+	row_conflict_latency = conflict_latency;
+	open_rows.assign(num_banks, NO_OPEN_ROW);
+	reset();
+	return true;
+}
+
+/* closes all the rows and clears the statistics */
+void dram::reset(){
+	fill(open_rows.begin(), open_rows.end(), NO_OPEN_ROW);
+	stats.row_hits = 0;
+	stats.row_misses = 0;
+	stats.row_conflicts = 0;
+}
@@ -0,0 +1,84 @@
+#ifndef DRAM_H_
+#define DRAM_H_
+
+#include <vector>
+
+using namespace std;
+
+/*
+DRAM timing model with banks and an open-row policy.
+The address of an access selects a bank and a row within the bank:
+  | row | bank | column |
+where the column bits address the bytes of a row (row_size bytes), and the bank bits select one of num_banks banks.
+Each bank keeps its last accessed row open in the row buffer, so that the latency of an access is:
+- row hit: the row is open in the row buffer
+- row miss: no row is open in the bank (first access to the bank)
+- row conflict: another row is open, and has to be closed first
+Only the state of the row buffers is modeled (accesses to a bank are not serialized).
+*/
+
+#define NO_OPEN_ROW 0xFFFFFFFF //no row open in the bank
+
+//DRAM statistics
+typedef struct{
+	unsigned row_hits; //accesses to the open row
+	unsigned row_misses; //accesses to a bank without an open row
+	unsigned row_conflicts; //accesses to a bank with another row open
+} dram_stats_t;
+
+class dram{
+
+	//configuration
+	unsigned num_banks; //number of banks (0 if the DRAM model is disabled)
+	unsigned row_bits; //log2(row_size)
+	unsigned row_hit_latency; //latencies (in clock cycles)
+	unsigned row_miss_latency;
+	unsigned row_conflict_latency;
+
+	//row open in each bank (NO_OPEN_ROW if none)
+	vector<unsigned> open_rows;
+
+	//statistics
+	dram_stats_t stats;
+
+public:
+
+	//instantiates a disabled DRAM model
+	dram();
+
+	//configures the DRAM model (all the rows are closed) - latencies in clock cycles
+	//returns false if the configuration is not valid (num_banks and row_size must be powers of 2, row_size at least a word)
+	bool configure(unsigned num_banks, unsigned row_size, unsigned row_hit_latency, unsigned row_miss_latency, unsigned row_conflict_latency);
+
+	//returns true if the DRAM model has been configured
+	inline bool is_enabled(){ return num_banks != 0; }
+
+	//accesses the specified address - returns the latency of the access (in clock cycles)
+	inline unsigned access(unsigned address){
+		unsigned bank = (address >> row_bits) & (num_banks-1);
+		unsigned row = (address >> row_bits) / num_banks;
+		unsigned &open_row = open_rows[bank];
+		if (open_row == row){
+			stats.row_hits++;
+			return row_hit_latency;
+		}
+		unsigned latency;
+		if (open_row == NO_OPEN_ROW){
+			stats.row_misses++;
+			latency = row_miss_latency;
+		} else {
+			stats.row_conflicts++;
+			latency = row_conflict_latency;
+		}
+		open_row = row;
+		return latency;
+	}
+
+	//closes all the rows and clears the statistics (the configuration is preserved)
+	void reset();
+
+	//returns the statistics
+	inline const dram_stats_t &get_stats(){ return stats; }
+};
+
+#endif /*DRAM_H_*/
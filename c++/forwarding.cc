@@ -0,0 +1,60 @@
+#include "forwarding.h"
+
+/* stages, as numbered by the stage_t enumeration of the simulators */
+#define STAGE_EXE 2
+#define STAGE_MEM 3
+#define STAGE_WB 4
+
+/* instantiates a network without forwarding */
+forwarding_network::forwarding_network(){
+	level = NO_FORWARDING;
+	reset();
+}
+
+/* sets the forwarding level */
+void forwarding_network::configure(forwarding_t level){
+	this->level = level;
+}
+
+/* returns the path through which an operand produced by an instruction in "producer_stage" reaches the instruction leaving ID */
+forwarding_path_t forwarding_network::path(unsigned producer_stage, unsigned produced_in, unsigned consumed_in){
+	// WB writes the register file before ID reads it
+	if (producer_stage == STAGE_WB) return PATH_REGISTER_FILE;
+	// when the consumer enters stage c, the producer has just left stage producer_stage+c-2, whose pipeline register holds the value
+	for (unsigned c=STAGE_EXE; c<=consumed_in; c++){
+		unsigned source = producer_stage + c - 2;
+		if (source < produced_in || source > STAGE_MEM) continue;
+		if (source == STAGE_EXE && c == STAGE_EXE && level >= FORWARD_EX_EX) return PATH_EX_EX;
+		if (source == STAGE_MEM && c == STAGE_EXE && level >= FORWARD_MEM_EX) return PATH_MEM_EX;
+		if (source == STAGE_MEM && c == STAGE_MEM && level == FULL_FORWARDING) return PATH_MEM_MEM;
+	}
+	return PATH_STALL;
+}
+
+/* updates the statistics for the operands of an instruction leaving ID */
+void forwarding_network::count(const forwarding_path_t paths[2], const unsigned producer_stages[2]){
+	// without forwarding, the instruction would wait in ID until its furthest producer reaches WB
+	unsigned saved = 0;
+	forwarding_path_t saved_path = PATH_STALL;
+	for (unsigned o=0; o<2; o++){
+		if (paths[o] >= NUM_FORWARDING_PATHS) continue;
+		forwarded_operands[paths[o]]++;
+		if (STAGE_WB - producer_stages[o] > saved){
+			saved = STAGE_WB - producer_stages[o];
+			saved_path = paths[o];
+		}
+	}
+	if (saved_path != PATH_STALL) saved_stalls[saved_path] += saved;
+}
+
+/* clears the statistics */
+void forwarding_network::reset(){
+	for (unsigned p=0; p<NUM_FORWARDING_PATHS; p++){
+		forwarded_operands[p] = 0;
+		saved_stalls[p] = 0;
+	}
+}
+
+unsigned forwarding_network::get_forwarded_operands(forwarding_path_t path){return (path < NUM_FORWARDING_PATHS) ? forwarded_operands[path] : 0;}
+
+unsigned forwarding_network::get_saved_stalls(forwarding_path_t path){return (path < NUM_FORWARDING_PATHS) ? saved_stalls[path] : 0;}
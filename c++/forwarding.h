@@ -0,0 +1,63 @@
+#ifndef FORWARDING_H_
+#define FORWARDING_H_
+
+using namespace std;
+
+/*
+Forwarding (bypass) network: operands are forwarded from the EX/MEM and MEM/WB pipeline registers
+to the stage which uses them (see init_forwarding). The forwarding levels are cumulative:
+- NO_FORWARDING: operands are only read from the register file, in ID (default)
+- FORWARD_EX_EX: EX/MEM -> EX
+- FORWARD_MEM_EX: EX/MEM -> EX and MEM/WB -> EX
+- FULL_FORWARDING: EX/MEM -> EX, MEM/WB -> EX and MEM/WB -> MEM (e.g., a loaded value stored by the next instruction)
+
+The network is shared by the integer and the floating point pipelines: stages are given by their index in the
+stage_t enumeration of the simulators (IF=0, ID=1, EXE=2, MEM=3, WB=4).
+*/
+typedef enum {NO_FORWARDING, FORWARD_EX_EX, FORWARD_MEM_EX, FULL_FORWARDING} forwarding_t;
+
+typedef enum {PATH_EX_EX, PATH_MEM_EX, PATH_MEM_MEM, PATH_REGISTER_FILE, PATH_STALL} forwarding_path_t;
+
+#define NUM_FORWARDING_PATHS 3 //forwarding paths proper (PATH_EX_EX, PATH_MEM_EX, PATH_MEM_MEM)
+
+class forwarding_network{
+
+	//configuration
+	forwarding_t level;
+
+	//statistics
+	unsigned forwarded_operands[NUM_FORWARDING_PATHS]; //operands forwarded through each path
+	unsigned saved_stalls[NUM_FORWARDING_PATHS]; //RAW stalls removed by each path
+
+public:
+
+	//instantiates a network without forwarding (NO_FORWARDING)
+	forwarding_network();
+
+	//sets the forwarding level
+	void configure(forwarding_t level);
+
+	//returns true if some forwarding path is enabled
+	inline bool is_enabled(){ return level != NO_FORWARDING; }
+
+	// RAW hazard on an operand of the instruction in ID, produced by an older instruction currently in stage "producer_stage"
+	// - produced_in: stage at the end of which the value is available (EXE for ALU operations, MEM for loads)
+	// - consumed_in: stage at the beginning of which the consumer uses the value (EXE, or MEM for the data of a store)
+	// returns the path through which the operand reaches the consumer if it leaves ID in this clock cycle, given the
+	// forwarding level: PATH_REGISTER_FILE if the producer is in WB, PATH_STALL if the consumer has to wait in ID
+	forwarding_path_t path(unsigned producer_stage, unsigned produced_in, unsigned consumed_in);
+
+	// updates the statistics for the two operands of an instruction, forwarded through "paths" (as returned by path for the same "producer_stages")
+	// - to be invoked once per instruction, when it leaves ID: each forwarded operand is counted, while the RAW stalls removed
+	//   are counted once, on the path of the operand whose producer was the furthest from WB (the one it would have waited for)
+	void count(const forwarding_path_t paths[2], const unsigned producer_stages[2]);
+
+	//clears the statistics (the configuration is preserved)
+	void reset();
+
+	//returns the number of operands forwarded through the given path, and the number of RAW stalls that path removed
+	unsigned get_forwarded_operands(forwarding_path_t path);
+	unsigned get_saved_stalls(forwarding_path_t path);
+};
+
+#endif /*FORWARDING_H_*/
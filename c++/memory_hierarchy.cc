@@ -0,0 +1,284 @@
+#include "memory_hierarchy.h"
+#include <iostream>
+#include <stdlib.h>
+#include <algorithm>
+
+static const char *cache_level_names[NUM_CACHE_LEVELS] = {"L1", "L2"};
+
+/* instantiates a hierarchy without caches */
+memory_hierarchy::memory_hierarchy(){
+	memory_latency = 0;
+	reset();
+}
+
+/* sets the main memory latency */
+void memory_hierarchy::set_memory_latency(unsigned latency){
+	memory_latency = latency;
+}
+
+/* configures a cache level */
+void memory_hierarchy::configure_cache(cache_level_t level, unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency, replacement_policy_t replacement, write_policy_t write_policy){
+	if (level != CACHE_L1 && !caches[CACHE_L1].is_enabled()){
+		cerr << "error: " << cache_level_names[level] << " cache configured without an L1 cache!" << endl;
+		exit(-1);
+	}
+	if (!caches[level].configure(size, associativity, line_size, hit_latency, replacement, write_policy)){
+		cerr << "error: invalid " << cache_level_names[level] << " cache configuration (size=" << size << " associativity=" << associativity << " line_size=" << line_size << ")!" << endl;
+		exit(-1);
+	}
+}
+
+/* configures the DRAM model of the main memory */
+void memory_hierarchy::configure_dram(unsigned num_banks, unsigned row_size, unsigned row_hit_latency, unsigned row_miss_latency, unsigned row_conflict_latency){
+	if (!main_memory.configure(num_banks, row_size, row_hit_latency, row_miss_latency, row_conflict_latency)){
+		cerr << "error: invalid DRAM configuration (banks=" << num_banks << " row_size=" << row_size << ")!" << endl;
+		exit(-1);
+	}
+}
+
+/* configures the prefetcher of the L1 cache */
+void memory_hierarchy::configure_prefetcher(unsigned table_size, unsigned degree){
+	if (!caches[CACHE_L1].is_enabled()){
+		cerr << "error: prefetcher configured without an L1 cache!" << endl;
+		exit(-1);
+	}
+	if (!l1_prefetcher.configure(table_size, degree)){
+		cerr << "error: invalid prefetcher configuration (table_size=" << table_size << " degree=" << degree << ")!" << endl;
+		exit(-1);
+	}
+	prefetch_queue.assign(PREFETCH_QUEUE_SIZE, mshr_t{INVALID_LINE, 0});
+}
+
+/* configures the store buffer */
+void memory_hierarchy::configure_store_buffer(unsigned num_entries){
+	store_buffer.assign(num_entries, store_buffer_entry_t{0, 0});
+	store_buffer_tail = 0;
+	last_drain_cycle = 0;
+}
+
+/* configures the MSHRs of the L1 cache */
+void memory_hierarchy::configure_mshrs(unsigned num_mshrs){
+	if (num_mshrs != 0 && !caches[CACHE_L1].is_enabled()){
+		cerr << "error: MSHRs configured without an L1 cache!" << endl;
+		exit(-1);
+	}
+	mshrs.assign(num_mshrs, mshr_t{INVALID_LINE, 0});
+}
+
+/* accesses the hierarchy starting from cache level "level" */
+unsigned memory_hierarchy::access_level(unsigned level, unsigned address, bool is_write){
+	if (level == NUM_CACHE_LEVELS || !caches[level].is_enabled()) return main_memory.is_enabled() ? main_memory.access(address) : memory_latency;
+	cache &c = caches[level];
+	unsigned writeback;
+	bool hit = c.access(address, is_write, writeback);
+	if (writeback != INVALID_LINE) access_level(level+1, writeback, true); //absorbed by the write buffer
+	unsigned latency = c.get_hit_latency();
+	if (is_write && c.get_write_policy() == WRITE_THROUGH){
+		// the write is forwarded to the next level: it waits for it only on a miss (no-write-allocate)
+		unsigned next_latency = access_level(level+1, address, true);
+		if (!hit) latency += next_latency;
+	} else if (!hit){
+		// line fill
+		latency += access_level(level+1, address, false);
+	}
+	return latency;
+}
+
+/* accesses the word at the specified address */
+unsigned memory_hierarchy::access(unsigned address, bool is_write){
+	return access_level(CACHE_L1, address, is_write);
+}
+
+/* issues an access to the word at the specified address at clock cycle "cycle" */
+unsigned memory_hierarchy::issue(unsigned address, bool is_write, unsigned cycle, unsigned pc){
+	if (!store_buffer.empty()){
+		if (is_write) return issue_store(address, cycle);
+		if (forward_load(address, cycle)) return cycle + STORE_BUFFER_LATENCY;
+	}
+
+	cache &l1 = caches[CACHE_L1];
+	bool miss = l1.is_enabled() && !l1.probe(address);
+	unsigned ready_cycle;
+	if (!miss && l1.is_enabled() && l1.is_prefetched(address)){
+		// first demand access to a prefetched line: it completes no earlier than the prefetch
+		ready_cycle = cycle + access(address, is_write);
+		prefetch_stats.useful++;
+		unsigned line = address / l1.get_line_size();
+		for (unsigned p=0; p<prefetch_queue.size(); p++){
+			if (prefetch_queue[p].line == line && prefetch_queue[p].ready_cycle > cycle){
+				prefetch_stats.late++;
+				ready_cycle = max(ready_cycle, prefetch_queue[p].ready_cycle);
+			}
+		}
+	} else {
+		ready_cycle = issue_demand(address, is_write, cycle);
+	}
+	if (ready_cycle != NOT_ISSUED && !is_write && l1_prefetcher.is_enabled()) issue_prefetches(address, pc, miss, cycle);
+	return ready_cycle;
+}
+
+/* issues a demand access, using an MSHR on a miss */
+unsigned memory_hierarchy::issue_demand(unsigned address, bool is_write, unsigned cycle){
+	if (mshrs.empty()) return cycle + access(address, is_write);
+
+	cache &l1 = caches[CACHE_L1];
+	unsigned line = address / l1.get_line_size();
+	mshr_t *free_mshr = NULL;
+	unsigned outstanding = 0;
+	for (unsigned m=0; m<mshrs.size(); m++){
+		if (mshrs[m].ready_cycle > cycle){
+			if (mshrs[m].line == line){
+				// secondary miss: completes when the line is filled
+				mshr_stats.secondary_misses++;
+				return max(mshrs[m].ready_cycle, cycle + l1.get_hit_latency());
+			}
+			outstanding++;
+		} else if (free_mshr == NULL){
+			free_mshr = &mshrs[m];
+		}
+	}
+
+	// hits, and write misses of a write-through cache (absorbed by the write buffer), do not need an MSHR
+	if (l1.probe(address) || (is_write && l1.get_write_policy() == WRITE_THROUGH)) return cycle + access(address, is_write);
+
+	if (free_mshr == NULL){
+		mshr_stats.mshr_full++;
+		return NOT_ISSUED;
+	}
+
+	// primary miss
+	unsigned ready_cycle = cycle + access(address, is_write);
+	free_mshr->line = line;
+	free_mshr->ready_cycle = ready_cycle;
+	mshr_stats.primary_misses++;
+	mshr_stats.max_outstanding = max(mshr_stats.max_outstanding, outstanding+1);
+	mshr_stats.miss_cycles += ready_cycle - cycle;
+	if (ready_cycle > busy_until){
+		mshr_stats.busy_cycles += ready_cycle - max(cycle, busy_until);
+		busy_until = ready_cycle;
+	}
+	return ready_cycle;
+}
+
+/* issues a store into the store buffer - the store is written to the L1 cache after the older ones */
+unsigned memory_hierarchy::issue_store(unsigned address, unsigned cycle){
+	store_buffer_entry_t &entry = store_buffer[store_buffer_tail];
+	if (entry.drain_cycle > cycle){
+		// the oldest store is still waiting to be written: the store buffer is full
+		store_buffer_stats.full_stalls++;
+		return NOT_ISSUED;
+	}
+	last_drain_cycle = max(cycle, last_drain_cycle) + access(address, true);
+	entry.address = address;
+	entry.drain_cycle = last_drain_cycle;
+	store_buffer_tail = (store_buffer_tail + 1) % store_buffer.size();
+	store_buffer_stats.buffered_stores++;
+	return cycle + STORE_BUFFER_LATENCY;
+}
+
+/* returns true if the load at "address" can be forwarded from a store in the store buffer */
+bool memory_hierarchy::forward_load(unsigned address, unsigned cycle){
+	for (unsigned e=0; e<store_buffer.size(); e++){
+		const store_buffer_entry_t &entry = store_buffer[e];
+		if (entry.address == address && entry.drain_cycle > cycle){
+			store_buffer_stats.forwarded_loads++;
+			return true;
+		}
+	}
+	return false;
+}
+
+/* trains the prefetcher with a load, and issues the resulting prefetches */
+void memory_hierarchy::issue_prefetches(unsigned address, unsigned pc, bool miss, unsigned cycle){
+	cache &l1 = caches[CACHE_L1];
+	unsigned addresses[MAX_PREFETCH_DEGREE];
+	unsigned num_prefetches = l1_prefetcher.train(pc, address, miss, l1.get_line_size(), addresses);
+	for (unsigned a=0; a<num_prefetches; a++){
+		if (l1.probe(addresses[a])) continue;
+		mshr_t *slot = NULL;
+		for (unsigned p=0; p<prefetch_queue.size() && slot == NULL; p++)
+			if (prefetch_queue[p].ready_cycle <= cycle) slot = &prefetch_queue[p];
+		if (slot == NULL){
+			prefetch_stats.dropped++;
+			continue;
+		}
+		unsigned writeback;
+		l1.prefetch(addresses[a], writeback);
+		if (writeback != INVALID_LINE) access_level(CACHE_L2, writeback, true); //absorbed by the write buffer
+		slot->line = addresses[a] / l1.get_line_size();
+		slot->ready_cycle = cycle + l1.get_hit_latency() + access_level(CACHE_L2, addresses[a], false);
+		prefetch_stats.issued++;
+	}
+}
+
+/* empties the caches and clears the statistics */
+void memory_hierarchy::reset(){
+	for (unsigned l=0; l<NUM_CACHE_LEVELS; l++) caches[l].invalidate();
+	main_memory.reset();
+	for (unsigned m=0; m<mshrs.size(); m++) mshrs[m] = mshr_t{INVALID_LINE, 0};
+	busy_until = 0;
+	mshr_stats.primary_misses = 0;
+	mshr_stats.secondary_misses = 0;
+	mshr_stats.mshr_full = 0;
+	mshr_stats.max_outstanding = 0;
+	mshr_stats.miss_cycles = 0;
+	mshr_stats.busy_cycles = 0;
+	l1_prefetcher.reset();
+	for (unsigned p=0; p<prefetch_queue.size(); p++) prefetch_queue[p] = mshr_t{INVALID_LINE, 0};
+	prefetch_stats.issued = 0;
+	prefetch_stats.dropped = 0;
+	prefetch_stats.useful = 0;
+	prefetch_stats.late = 0;
+	fill(store_buffer.begin(), store_buffer.end(), store_buffer_entry_t{0, 0});
+	store_buffer_tail = 0;
+	last_drain_cycle = 0;
+	store_buffer_stats.buffered_stores = 0;
+	store_buffer_stats.forwarded_loads = 0;
+	store_buffer_stats.full_stalls = 0;
+}
+
+/* returns the statistics of a cache level */
+const cache_stats_t &memory_hierarchy::get_cache_stats(cache_level_t level){
+	return caches[level].get_stats();
+}
+
+/* returns the statistics of the DRAM model */
+const dram_stats_t &memory_hierarchy::get_dram_stats(){
+	return main_memory.get_stats();
+}
+
+/* returns the statistics of the non-blocking cache */
+const mshr_stats_t &memory_hierarchy::get_mshr_stats(){
+	return mshr_stats;
+}
+
+/* returns the memory-level parallelism */
+float memory_hierarchy::get_memory_level_parallelism(){
+	return mshr_stats.busy_cycles == 0 ? 0 : (float)mshr_stats.miss_cycles/mshr_stats.busy_cycles;
+}
+
+/* returns the statistics of the prefetcher */
+const prefetch_stats_t &memory_hierarchy::get_prefetch_stats(){
+	return prefetch_stats;
+}
+
+/* returns the accuracy of the prefetcher */
+float memory_hierarchy::get_prefetch_accuracy(){
+	return prefetch_stats.issued == 0 ? 0 : (float)prefetch_stats.useful/prefetch_stats.issued;
+}
+
+/* returns the coverage of the prefetcher */
+float memory_hierarchy::get_prefetch_coverage(){
+	unsigned misses = prefetch_stats.useful + caches[CACHE_L1].get_stats().misses;
+	return misses == 0 ? 0 : (float)prefetch_stats.useful/misses;
+}
+
+/* returns the timeliness of the prefetcher */
+float memory_hierarchy::get_prefetch_timeliness(){
+	return prefetch_stats.useful == 0 ? 0 : (float)(prefetch_stats.useful-prefetch_stats.late)/prefetch_stats.useful;
+}
+
+/* returns the statistics of the store buffer */
+const store_buffer_stats_t &memory_hierarchy::get_store_buffer_stats(){
+	return store_buffer_stats;
+}
@@ -0,0 +1,200 @@
+#ifndef MEMORY_HIERARCHY_H_
+#define MEMORY_HIERARCHY_H_
+
+#include "cache.h"
+#include "dram.h"
+#include "prefetcher.h"
+
+using namespace std;
+
+/*
+Timing model of the data memory hierarchy: an optional L1 cache, an optional L2 cache (which requires L1),
+and the main memory.
+The main memory has either a fixed latency (i.e., the data_memory_latency of the simulators), or the latency
+given by the DRAM model (see dram.h), if configured. Without caches, every access goes to the main memory.
+
+The latency of an access is the sum of the hit latencies of the levels looked up, plus the main memory
+latency if it misses in all of them. Write-backs of dirty lines, and the writes propagated by write-through
+caches, update the state of the next level, but are assumed to be absorbed by a write buffer (i.e., they
+do not add to the latency of the access).
+
+Non-blocking caches: with miss status holding registers (MSHRs), the L1 cache keeps serving accesses while
+up to "num_mshrs" misses (to different lines) are outstanding. Accesses are issued at a given clock cycle
+(see issue), and return the clock cycle at which they complete. A miss to a line which is already being
+fetched is merged into the MSHR of that line (secondary miss), and completes with it. When all the MSHRs
+are busy, a miss cannot be issued (NOT_ISSUED), and has to be retried later.
+Memory-level parallelism (MLP) is the average number of outstanding misses over the clock cycles in which
+at least one miss is outstanding.
+
+Prefetching: the prefetcher (see prefetcher.h) is trained by the loads issued (see issue), and brings lines
+into the L1 cache ahead of the demand accesses. Prefetches in flight are tracked in a prefetch queue of
+PREFETCH_QUEUE_SIZE entries (they do not take MSHRs), and are dropped when the queue is full. A demand access
+to a prefetched line completes no earlier than the prefetch (late prefetch if it has to wait for it).
+- accuracy: fraction of the prefetched lines accessed by a demand access
+- coverage: fraction of the L1 misses removed by prefetching (prefetched lines accessed / (those + L1 misses))
+- timeliness: fraction of the prefetched lines accessed which were not late
+
+Store buffer: with a store buffer, the stores issued (see issue) complete in STORE_BUFFER_LATENCY clock cycles,
+and are written to the L1 cache in the background, one at a time in program order. When the store buffer is full,
+a store cannot be issued (NOT_ISSUED). A load to the same address as a store still in the store buffer gets the
+value forwarded from the youngest such store, in STORE_BUFFER_LATENCY clock cycles; other loads bypass the
+buffered stores. Accesses are words at aligned addresses, so that forwarding only needs an address match.
+(As with the caches, this is a timing model: the data memory is always updated when the store is executed.)
+*/
+
+typedef enum {CACHE_L1, CACHE_L2} cache_level_t;
+
+#define NUM_CACHE_LEVELS 2
+
+#define NOT_ISSUED 0xFFFFFFFF //returned by issue when the access cannot be issued (all the MSHRs busy, or store buffer full)
+
+#define STORE_BUFFER_LATENCY 1 //latency of the stores entering the store buffer, and of the loads forwarded from it
+
+#define PREFETCH_QUEUE_SIZE 16 //maximum number of prefetches in flight
+
+//miss status holding register
+typedef struct{
+	unsigned line; //line address (address / L1 line size)
+	unsigned ready_cycle; //clock cycle at which the line is filled (the MSHR is free from that cycle on)
+} mshr_t;
+
+//statistics of the non-blocking cache
+typedef struct{
+	unsigned primary_misses; //misses which allocated an MSHR
+	unsigned secondary_misses; //misses merged into the MSHR of an outstanding miss to the same line
+	unsigned mshr_full; //accesses which could not be issued because all the MSHRs were busy
+	unsigned max_outstanding; //maximum number of outstanding misses
+	unsigned long long miss_cycles; //sum of the latencies of the primary misses
+	unsigned long long busy_cycles; //clock cycles with at least one outstanding miss
+} mshr_stats_t;
+
+//statistics of the prefetcher
+typedef struct{
+	unsigned issued; //prefetches which brought a line into the L1 cache
+	unsigned dropped; //prefetches dropped because the prefetch queue was full
+	unsigned useful; //prefetched lines accessed by a demand access
+	unsigned late; //prefetched lines accessed by a demand access before the prefetch completed
+} prefetch_stats_t;
+
+//store buffer entry
+typedef struct{
+	unsigned address; //address of the store
+	unsigned drain_cycle; //clock cycle at which the store is written to the L1 cache (the entry is free from that cycle on)
+} store_buffer_entry_t;
+
+//statistics of the store buffer
+typedef struct{
+	unsigned buffered_stores; //stores which entered the store buffer
+	unsigned forwarded_loads; //loads which got their value from the store buffer
+	unsigned full_stalls; //stores which could not be issued because the store buffer was full
+} store_buffer_stats_t;
+
+class memory_hierarchy{
+
+	//caches (level CACHE_L1 is the closest to the processor)
+	cache caches[NUM_CACHE_LEVELS];
+
+	//main memory latency (in clock cycles) - used if the DRAM model is not configured
+	unsigned memory_latency;
+
+	//DRAM model of the main memory
+	dram main_memory;
+
+	//MSHRs of the L1 cache (empty if the caches are blocking)
+	vector<mshr_t> mshrs;
+
+	//clock cycle until which at least one miss is outstanding (used to compute busy_cycles)
+	unsigned busy_until;
+
+	//statistics of the non-blocking cache
+	mshr_stats_t mshr_stats;
+
+	//prefetcher of the L1 cache, and prefetches in flight (line and clock cycle at which it is filled)
+	prefetcher l1_prefetcher;
+	vector<mshr_t> prefetch_queue;
+
+	//statistics of the prefetcher
+	prefetch_stats_t prefetch_stats;
+
+	//store buffer (empty if stores are not buffered), managed as a circular FIFO
+	vector<store_buffer_entry_t> store_buffer;
+	unsigned store_buffer_tail; //entry allocated to the next store (the oldest one)
+	unsigned last_drain_cycle; //clock cycle at which the youngest store is written to the L1 cache
+
+	//statistics of the store buffer
+	store_buffer_stats_t store_buffer_stats;
+
+	//accesses the hierarchy starting from cache level "level" - returns the latency of the access (in clock cycles)
+	unsigned access_level(unsigned level, unsigned address, bool is_write);
+
+	//issues a demand access, using an MSHR on a miss (see issue)
+	unsigned issue_demand(unsigned address, bool is_write, unsigned cycle);
+
+	//issues a store into the store buffer
+	unsigned issue_store(unsigned address, unsigned cycle);
+
+	//returns true if the load at "address" can be forwarded from a store in the store buffer
+	bool forward_load(unsigned address, unsigned cycle);
+
+	//trains the prefetcher with a load, and issues the resulting prefetches
+	void issue_prefetches(unsigned address, unsigned pc, bool miss, unsigned cycle);
+
+public:
+
+	//instantiates a hierarchy without caches
+	memory_hierarchy();
+
+	//sets the main memory latency (in clock cycles)
+	void set_memory_latency(unsigned latency);
+
+	//configures a cache level (see cache::configure) - exits with an error if the configuration is not valid
+	void configure_cache(cache_level_t level, unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency, replacement_policy_t replacement, write_policy_t write_policy);
+
+	//configures the DRAM model of the main memory (see dram::configure) - exits with an error if the configuration is not valid
+	void configure_dram(unsigned num_banks, unsigned row_size, unsigned row_hit_latency, unsigned row_miss_latency, unsigned row_conflict_latency);
+
+	//configures the prefetcher of the L1 cache (see prefetcher::configure) - exits with an error if the L1 cache is not configured
+	void configure_prefetcher(unsigned table_size, unsigned degree);
+
+	//configures a store buffer with "num_entries" entries (0: stores are not buffered)
+	void configure_store_buffer(unsigned num_entries);
+
+	//configures "num_mshrs" MSHRs for the L1 cache (0: blocking caches) - exits with an error if the L1 cache is not configured
+	void configure_mshrs(unsigned num_mshrs);
+
+	//accesses the word at the specified address - returns the latency of the access (in clock cycles)
+	unsigned access(unsigned address, bool is_write);
+
+	//issues an access to the word at the specified address at clock cycle "cycle" (non-decreasing across calls), by the instruction at "pc"
+	//returns the clock cycle at which the access completes, or NOT_ISSUED if the access cannot be issued
+	//with blocking caches and no store buffer, the access is always issued, and completes after the latency returned by "access" (or when the line is prefetched)
+	unsigned issue(unsigned address, bool is_write, unsigned cycle, unsigned pc=NO_PC);
+
+	//empties the caches and clears the statistics (the configuration is preserved)
+	void reset();
+
+	//returns the statistics of a cache level (all zero if that level is not configured)
+	const cache_stats_t &get_cache_stats(cache_level_t level);
+
+	//returns the statistics of the DRAM model (all zero if not configured)
+	const dram_stats_t &get_dram_stats();
+
+	//returns the statistics of the non-blocking cache
+	const mshr_stats_t &get_mshr_stats();
+
+	//returns the memory-level parallelism (0 if no miss has been issued)
+	float get_memory_level_parallelism();
+
+	//returns the statistics of the prefetcher
+	const prefetch_stats_t &get_prefetch_stats();
+
+	//returns the accuracy, coverage and timeliness of the prefetcher (0 if undefined)
+	float get_prefetch_accuracy();
+	float get_prefetch_coverage();
+	float get_prefetch_timeliness();
+
+	//returns the statistics of the store buffer
+	const store_buffer_stats_t &get_store_buffer_stats();
+};
+
+#endif /*MEMORY_HIERARCHY_H_*/
@@ -0,0 +1,205 @@
+#include "paged_memory.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* releases a reference to a page, de-allocating it when no longer used */
+static inline void release_page(memory_page_t *page){
+	if (--page->refs == 0) delete page;
+}
+
+/* instantiates an empty memory */
+paged_memory::paged_memory(){
+	for (unsigned d=0; d<MEMORY_DIRECTORY_SIZE; d++) directory[d] = NULL;
+	num_pages = 0;
+	generation = 1;
+}
+
+/* instantiates a copy of "other" (copy-on-write) */
+paged_memory::paged_memory(const paged_memory &other){
+	for (unsigned d=0; d<MEMORY_DIRECTORY_SIZE; d++) directory[d] = NULL;
+	num_pages = 0;
+	copy_from(other);
+}
+
+/* replaces the content of the memory with the one of "other" (copy-on-write) */
+paged_memory &paged_memory::operator=(const paged_memory &other){
+	if (this != &other){
+		clear();
+		copy_from(other);
+	}
+	return *this;
+}
+
+/* de-allocates the memory */
+paged_memory::~paged_memory(){
+	clear();
+}
+
+/* shares the pages of "other" which are valid in its current generation */
+void paged_memory::copy_from(const paged_memory &other){
+	generation = other.generation;
+	for (unsigned d=0; d<MEMORY_DIRECTORY_SIZE; d++){
+		if (other.directory[d] == NULL) continue;
+		directory[d] = new memory_page_t*[MEMORY_TABLE_SIZE];
+		for (unsigned p=0; p<MEMORY_TABLE_SIZE; p++){
+			memory_page_t *page = other.directory[d][p];
+			if (page != NULL && page->generation == generation){
+				page->refs++;
+				num_pages++;
+			} else {
+				page = NULL;
+			}
+			directory[d][p] = page;
+		}
+	}
+}
+
+/* releases all the pages and page tables */
+void paged_memory::clear(){
+	for (unsigned d=0; d<MEMORY_DIRECTORY_SIZE; d++){
+		if (directory[d] == NULL) continue;
+		for (unsigned p=0; p<MEMORY_TABLE_SIZE; p++)
+			if (directory[d][p] != NULL) release_page(directory[d][p]);
+		delete [] directory[d];
+		directory[d] = NULL;
+	}
+	num_pages = 0;
+}
+
+/* returns the page containing "address", ready to be written */
+memory_page_t *paged_memory::writable_page(unsigned address){
+	unsigned page_number = address >> MEMORY_PAGE_BITS;
+	memory_page_t **&table = directory[page_number >> MEMORY_TABLE_BITS];
+	if (table == NULL){
+		table = new memory_page_t*[MEMORY_TABLE_SIZE];
+		for (unsigned p=0; p<MEMORY_TABLE_SIZE; p++) table[p] = NULL;
+	}
+	memory_page_t *&page = table[page_number & (MEMORY_TABLE_SIZE-1)];
+	if (page != NULL && page->refs != 1){
+		// page shared with another memory: this memory gets its own copy
+		memory_page_t *copy = new memory_page_t;
+		copy->refs = 1;
+		copy->generation = generation;
+		if (page->generation == generation) memcpy(copy->data, page->data, MEMORY_PAGE_SIZE);
+		else memset(copy->data, MEMORY_FILL, MEMORY_PAGE_SIZE);
+		release_page(page);
+		page = copy;
+	}
+	if (page == NULL){
+		page = new memory_page_t;
+		page->refs = 1;
+		page->generation = 0; //never a valid generation
+		num_pages++;
+	}
+	if (page->generation != generation){
+		memset(page->data, MEMORY_FILL, MEMORY_PAGE_SIZE);
+		page->generation = generation;
+	}
+	return page;
+}
+
+/* returns the (little-endian) word at the specified address */
+unsigned paged_memory::read_word(unsigned address){
+	unsigned value;
+	if ((address & (MEMORY_PAGE_SIZE-1)) <= MEMORY_PAGE_SIZE - sizeof value){
+		// word within a single page
+		memory_page_t *page = find_page(address);
+		if (page == NULL) return MEMORY_FILL * 0x01010101u;
+		memcpy(&value, page->data + (address & (MEMORY_PAGE_SIZE-1)), sizeof value);
+		return value;
+	}
+	// word straddling two pages
+	value = 0;
+	for (unsigned b=0; b<sizeof value; b++) value |= read_byte(address+b) << (8*b);
+	return value;
+}
+
+/* writes the (little-endian) word at the specified address */
+void paged_memory::write_word(unsigned address, unsigned value){
+	if ((address & (MEMORY_PAGE_SIZE-1)) <= MEMORY_PAGE_SIZE - sizeof value){
+		// word within a single page
+		memory_page_t *page = find_page(address);
+		if (page == NULL || page->refs != 1) page = writable_page(address);
+		memcpy(page->data + (address & (MEMORY_PAGE_SIZE-1)), &value, sizeof value);
+		return;
+	}
+	// word straddling two pages
+	for (unsigned b=0; b<sizeof value; b++) write_byte(address+b, (value >> (8*b)) & 0xFF);
+}
+
+/* writes "size" bytes from "data" starting at the specified address */
+void paged_memory::write_block(unsigned address, const unsigned char *data, unsigned size){
+	while (size > 0){
+		unsigned offset = address & (MEMORY_PAGE_SIZE-1);
+		unsigned chunk = MEMORY_PAGE_SIZE - offset;
+		if (chunk > size) chunk = size;
+		memcpy(writable_page(address)->data + offset, data, chunk);
+		address += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+}
+
+/* loads the memory image in file "filename" (raw binary or sectioned image) starting at the specified base address */
+bool paged_memory::load_image(const char *filename, unsigned base_address){
+	int fd = open(filename, O_RDONLY);
+	struct stat file_stat;
+	if (fd < 0 || fstat(fd, &file_stat) < 0){
+		if (fd >= 0) close(fd);
+		return false;
+	}
+	size_t size = file_stat.st_size;
+	if (size == 0){
+		close(fd);
+		return true;
+	}
+	const unsigned char *image = (const unsigned char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (image == MAP_FAILED) return false;
+
+	bool ok = true;
+	const memory_image_header_t *header = (const memory_image_header_t *) image;
+	if (size >= sizeof(header->magic) && header->magic == MEMORY_IMAGE_MAGIC){
+		// sectioned image: all the sections are validated before writing the first one
+		ok = (size >= sizeof(memory_image_header_t) && header->version == MEMORY_IMAGE_VERSION && header->size == size);
+		size_t offset = sizeof(memory_image_header_t);
+		for (unsigned s=0; s<header->num_sections && ok; s++){
+			const memory_image_section_t *section = (const memory_image_section_t *) (image + offset);
+			ok = (offset + sizeof(memory_image_section_t) <= size);
+			if (ok) offset += sizeof(memory_image_section_t) + section->size;
+			ok = ok && offset <= size && (unsigned long long) base_address + section->address + section->size <= (1ULL << 32);
+		}
+		ok = ok && offset == size;
+		offset = sizeof(memory_image_header_t);
+		for (unsigned s=0; s<header->num_sections && ok; s++){
+			const memory_image_section_t *section = (const memory_image_section_t *) (image + offset);
+			offset += sizeof(memory_image_section_t);
+			write_block(base_address + section->address, image + offset, section->size);
+			offset += section->size;
+		}
+	} else {
+		// raw binary
+		ok = ((unsigned long long) base_address + size <= (1ULL << 32));
+		if (ok) write_block(base_address, image, size);
+	}
+
+	munmap((void *) image, size);
+	return ok;
+}
+
+/* resets all locations to MEMORY_FILL: the pages written so far become stale, and are re-initialized when written again */
+void paged_memory::reset(){
+	generation++;
+	if (generation == 0){
+		// generation counter wrapped around: release all the pages explicitly
+		clear();
+		generation = 1;
+	}
+}
+
+/* returns the number of pages currently referenced */
+unsigned paged_memory::get_allocated_pages(){
+	return num_pages;
+}
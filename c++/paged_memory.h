@@ -0,0 +1,137 @@
+#ifndef PAGED_MEMORY_H_
+#define PAGED_MEMORY_H_
+
+#include <string.h>
+#include <atomic>
+
+using namespace std;
+
+/*
+Sparse data memory.
+The 32-bit address space is split into pages, which are allocated on first write:
+locations which have never been written read as 0xFF, and cost no storage.
+Pages are located through a two-level table (directory -> page table -> page).
+
+Resetting the memory is O(1): each page is tagged with the generation in which it was last
+written, and reset simply starts a new generation. Pages of older generations read as 0xFF,
+and are re-initialized (and re-used) the first time they are written again.
+
+Copying a memory is cheap: pages are shared between the copies, and duplicated only when one
+of the copies writes them (copy-on-write).
+*/
+
+#define MEMORY_PAGE_BITS 12 //4KB pages
+#define MEMORY_PAGE_SIZE (1 << MEMORY_PAGE_BITS)
+#define MEMORY_TABLE_BITS 10 //pages per page table (4MB of address space per page table)
+#define MEMORY_TABLE_SIZE (1 << MEMORY_TABLE_BITS)
+#define MEMORY_DIRECTORY_SIZE (1 << (32 - MEMORY_PAGE_BITS - MEMORY_TABLE_BITS))
+#define MEMORY_FILL 0xFF //value of locations never written
+
+/*
+Data memory image (see load_image), either:
+- a raw binary file, loaded as is at the base address, or
+- a sectioned image: a header (memory_image_header_t) followed by "num_sections" sections,
+  each one made of a section header (memory_image_section_t) followed by "size" bytes of data.
+  Section addresses are relative to the base address. All fields are little-endian.
+An image is loaded only if it is valid as a whole (version, total size, and every section within the image and
+the address space): nothing is written otherwise.
+*/
+#define MEMORY_IMAGE_MAGIC 0x4D454D44 //"DMEM"
+#define MEMORY_IMAGE_VERSION 1
+
+typedef struct{
+	unsigned magic; //MEMORY_IMAGE_MAGIC
+	unsigned version; //MEMORY_IMAGE_VERSION
+	unsigned size; //size of the whole image, header included (in bytes)
+	unsigned num_sections; //number of sections
+} memory_image_header_t;
+
+typedef struct{
+	unsigned address; //address of the section (relative to the base address)
+	unsigned size; //size of the section data (in bytes)
+} memory_image_section_t;
+
+// memory page
+typedef struct{
+	atomic<unsigned> refs; //number of memories sharing the page
+	unsigned generation; //generation in which the page was last written - the content is valid only in that generation
+	unsigned char data[MEMORY_PAGE_SIZE];
+} memory_page_t;
+
+class paged_memory{
+
+	//directory of page tables (NULL if none of the pages of a table has ever been written)
+	memory_page_t **directory[MEMORY_DIRECTORY_SIZE];
+
+	//number of pages referenced by this memory
+	unsigned num_pages;
+
+	//current generation - incremented at each reset
+	unsigned generation;
+
+	//returns the page containing "address" (NULL if not written in the current generation)
+	inline memory_page_t *find_page(unsigned address){
+		memory_page_t **table = directory[address >> (MEMORY_PAGE_BITS + MEMORY_TABLE_BITS)];
+		if (table == NULL) return NULL;
+		memory_page_t *page = table[(address >> MEMORY_PAGE_BITS) & (MEMORY_TABLE_SIZE-1)];
+		return (page == NULL || page->generation != generation) ? NULL : page;
+	}
+
+	//returns the page containing "address", ready to be written: the page is allocated if needed,
+	//re-initialized if last written in an older generation, and duplicated if shared with another memory
+	memory_page_t *writable_page(unsigned address);
+
+	//shares the pages of "other" (copy-on-write)
+	void copy_from(const paged_memory &other);
+
+	//releases all the pages and page tables
+	void clear();
+
+public:
+
+	//instantiates an empty memory (all locations set to MEMORY_FILL)
+	paged_memory();
+
+	//instantiates a copy of "other" - the pages are shared, and copied only when written
+	paged_memory(const paged_memory &other);
+
+	//replaces the content of the memory with the one of "other" - the pages are shared, and copied only when written
+	paged_memory &operator=(const paged_memory &other);
+
+	//de-allocates the memory
+	~paged_memory();
+
+	//returns the byte at the specified address
+	inline unsigned char read_byte(unsigned address){
+		memory_page_t *page = find_page(address);
+		return (page == NULL) ? MEMORY_FILL : page->data[address & (MEMORY_PAGE_SIZE-1)];
+	}
+
+	//writes the byte at the specified address
+	inline void write_byte(unsigned address, unsigned char value){
+		memory_page_t *page = find_page(address);
+		if (page == NULL || page->refs != 1) page = writable_page(address);
+		page->data[address & (MEMORY_PAGE_SIZE-1)] = value;
+	}
+
+	//returns the (little-endian) word at the specified address
+	unsigned read_word(unsigned address);
+
+	//writes the (little-endian) word at the specified address
+	void write_word(unsigned address, unsigned value);
+
+	//writes "size" bytes from "data" starting at the specified address (one copy per page)
+	void write_block(unsigned address, const unsigned char *data, unsigned size);
+
+	//loads the memory image in file "filename" starting at the specified base address
+	//returns false, leaving the memory unchanged, if the file cannot be read or the image is not valid
+	bool load_image(const char *filename, unsigned base_address);
+
+	//resets all locations to MEMORY_FILL in O(1), by starting a new generation
+	void reset();
+
+	//returns the number of pages currently referenced (including the ones kept for re-use after a reset)
+	unsigned get_allocated_pages();
+};
+
+#endif /*PAGED_MEMORY_H_*/
@@ -0,0 +1,55 @@
+#include "prefetcher.h"
+
+/* instantiates a disabled prefetcher */
+prefetcher::prefetcher(){
+	degree = 0;
+}
+
+/* configures (and empties) the prefetcher */
+bool prefetcher::configure(unsigned table_size, unsigned prefetch_degree){
+	if (table_size == 0 || (table_size & (table_size-1)) != 0 || prefetch_degree == 0 || prefetch_degree > MAX_PREFETCH_DEGREE) return false;
+	table.resize(table_size);
+	degree = prefetch_degree;
+	reset();
+	return true;
+}
+
+/* empties the stride table */
+void prefetcher::reset(){
+	for (unsigned e=0; e<table.size(); e++){
+		table[e].pc = NO_PC;
+		table[e].last_address = 0;
+		table[e].stride = 0;
+		table[e].confidence = 0;
+	}
+}
+
+/* trains the prefetcher with a demand load, and returns the addresses to be prefetched */
+unsigned prefetcher::train(unsigned pc, unsigned address, bool miss, unsigned line_size, unsigned *addresses){
+	if (pc != NO_PC){
+		stride_entry_t &entry = table[(pc >> 2) & (table.size()-1)];
+		if (entry.pc == pc){
+			int stride = (int)(address - entry.last_address);
+			if (stride != 0 && stride == entry.stride){
+				if (entry.confidence < MAX_CONFIDENCE) entry.confidence++;
+			} else {
+				entry.stride = stride;
+				entry.confidence = 0;
+			}
+		} else {
+			entry.pc = pc;
+			entry.stride = 0;
+			entry.confidence = 0;
+		}
+		entry.last_address = address;
+		if (entry.confidence >= PREFETCH_CONFIDENCE){
+			for (unsigned d=0; d<degree; d++) addresses[d] = address + (d+1)*entry.stride;
+			return degree;
+		}
+	}
+	if (!miss) return 0;
+	// next-line fallback
+	unsigned line = address & ~(line_size-1);
+	for (unsigned d=0; d<degree; d++) addresses[d] = line + (d+1)*line_size;
+	return degree;
+}
@@ -0,0 +1,62 @@
+#ifndef PREFETCHER_H_
+#define PREFETCHER_H_
+
+#include <vector>
+
+using namespace std;
+
+/*
+Stride prefetcher.
+A direct-mapped table, indexed by the PC of the load, records for each load the last address accessed,
+the last stride observed and a confidence counter. Once the same (non-zero) stride has been confirmed
+PREFETCH_CONFIDENCE times in a row, each execution of the load prefetches the next "degree" addresses
+along the stride. Loads without a confident stride fall back to next-line prefetching when they miss:
+the "degree" lines following the one accessed are prefetched.
+*/
+
+#define NO_PC 0xFFFFFFFF //access without a PC (trains next-line prefetching only)
+#define PREFETCH_CONFIDENCE 2 //stride confirmations required before prefetching along it
+#define MAX_CONFIDENCE 3 //saturation value of the confidence counters
+#define MAX_PREFETCH_DEGREE 8 //maximum number of addresses prefetched at each trigger
+
+//entry of the stride table
+typedef struct{
+	unsigned pc; //PC of the load (NO_PC if the entry is empty)
+	unsigned last_address; //last address accessed by the load
+	int stride; //last stride observed
+	unsigned char confidence; //number of times the stride has been confirmed in a row (saturating)
+} stride_entry_t;
+
+class prefetcher{
+
+	//stride table (empty if the prefetcher is disabled)
+	vector<stride_entry_t> table;
+
+	//number of addresses prefetched at each trigger
+	unsigned degree;
+
+public:
+
+	//instantiates a disabled prefetcher
+	prefetcher();
+
+	//configures (and empties) the prefetcher
+	//returns false if the configuration is not valid (table_size must be a power of 2, degree between 1 and MAX_PREFETCH_DEGREE)
+	bool configure(unsigned table_size, unsigned degree);
+
+	//returns true if the prefetcher has been configured
+	inline bool is_enabled(){ return !table.empty(); }
+
+	//returns the number of addresses prefetched at each trigger
+	inline unsigned get_degree(){ return degree; }
+
+	//trains the prefetcher with a demand load at "address" by the load at "pc", which missed in the cache if "miss"
+	//stores the addresses to be prefetched in "addresses" (MAX_PREFETCH_DEGREE entries), and returns their number
+	//line_size is the size of the cache lines (used for next-line prefetching)
+	unsigned train(unsigned pc, unsigned address, bool miss, unsigned line_size, unsigned *addresses);
+
+	//empties the stride table (the configuration is preserved)
+	void reset();
+};
+
+#endif /*PREFETCHER_H_*/
@@ -0,0 +1,461 @@
+#include "program.h"
+#include <stdlib.h>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static const char *instr_names[NUM_ISA_OPCODES] = {"LW", "SW", "ADD", "ADDI", "SUB", "SUBI", "XOR", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "JUMP", "EOP", "NOP", "LWS", "SWS", "ADDS", "SUBS", "MULTS", "DIVS"};
+
+//empty instruction slot
+static const instruction_t nop_instruction = {NOP, 0, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED, UNDEFINED};
+
+/* the following functions return the kind of the considered opcode */
+
+static bool is_branch(opcode_t opcode){
+	return (opcode == BEQZ || opcode == BNEZ || opcode == BLTZ || opcode == BLEZ || opcode == BGTZ || opcode == BGEZ || opcode == JUMP);
+}
+
+static bool is_memory(opcode_t opcode){
+        return (opcode == LW || opcode == SW || opcode == LWS || opcode == SWS);
+}
+
+static bool is_int_r(opcode_t opcode){
+        return (opcode == ADD || opcode == SUB || opcode == XOR);
+}
+
+static bool is_int_imm(opcode_t opcode){
+        return (opcode == ADDI || opcode == SUBI);
+}
+
+static bool is_fp_alu(opcode_t opcode){
+        return (opcode == ADDS || opcode == SUBS || opcode == MULTS || opcode == DIVS);
+}
+
+/* returns the number of operands of the instruction in assembly (see the instruction encoding of the simulators) */
+static unsigned num_operands(opcode_t opcode){
+        if (is_int_r(opcode) || is_int_imm(opcode) || is_fp_alu(opcode)) return 3;
+        if (is_memory(opcode) || (is_branch(opcode) && opcode != JUMP)) return 2;
+        if (opcode == JUMP) return 1;
+        return 0;
+}
+
+/* returns the class flags of the instruction (precomputed at load time in instruction_t.flags) */
+static unsigned char instr_flags(opcode_t opcode){
+        unsigned char flags = 0;
+        if (is_branch(opcode)) flags |= CLASS_BRANCH;
+        if (is_memory(opcode)) flags |= CLASS_MEMORY;
+        if (opcode == LW || opcode == LWS) flags |= CLASS_LOAD;
+        if (opcode == SW || opcode == SWS) flags |= CLASS_STORE;
+        if (is_int_r(opcode)) flags |= CLASS_INT_R;
+        if (is_int_imm(opcode)) flags |= CLASS_INT_IMM;
+        if (is_fp_alu(opcode)) flags |= CLASS_FP_ALU | CLASS_FP;
+        if (opcode == LWS || opcode == SWS) flags |= CLASS_FP;
+        return flags;
+}
+
+/* ========================parser ==================================== */
+
+/* returns true for the characters separating the tokens of an assembly line */
+static inline bool is_separator(char c){
+	return (c == ' ' || c == '\t' || c == '\r');
+}
+
+/* returns true if "name" is the mnemonic of "opcode" */
+static inline bool is_opcode(string_view name, opcode_t opcode){
+	return (name == instr_names[opcode]);
+}
+
+/* returns the opcode with mnemonic "name", or NUM_ISA_OPCODES if "name" is not a valid opcode
+   (switch on the mnemonic length and first letter, followed by a single comparison) */
+static unsigned lookup_opcode(string_view name){
+	switch(name.length()){
+		case 2:
+			if (is_opcode(name, LW)) return LW;
+			if (is_opcode(name, SW)) return SW;
+			break;
+		case 3:
+			switch(name[0]){
+				case 'A': if (is_opcode(name, ADD)) return ADD; break;
+				case 'S': if (is_opcode(name, SUB)) return SUB; if (is_opcode(name, SWS)) return SWS; break;
+				case 'X': if (is_opcode(name, XOR)) return XOR; break;
+				case 'E': if (is_opcode(name, EOP)) return EOP; break;
+				case 'N': if (is_opcode(name, NOP)) return NOP; break;
+				case 'L': if (is_opcode(name, LWS)) return LWS; break;
+			}
+			break;
+		case 4:
+			switch(name[0]){
+				case 'A': if (is_opcode(name, ADDI)) return ADDI; if (is_opcode(name, ADDS)) return ADDS; break;
+				case 'S': if (is_opcode(name, SUBI)) return SUBI; if (is_opcode(name, SUBS)) return SUBS; break;
+				case 'D': if (is_opcode(name, DIVS)) return DIVS; break;
+				case 'J': if (is_opcode(name, JUMP)) return JUMP; break;
+				case 'B':
+					switch(name[1]){
+						case 'E': if (is_opcode(name, BEQZ)) return BEQZ; break;
+						case 'N': if (is_opcode(name, BNEZ)) return BNEZ; break;
+						case 'L': if (is_opcode(name, BLTZ)) return BLTZ; if (is_opcode(name, BLEZ)) return BLEZ; break;
+						case 'G': if (is_opcode(name, BGTZ)) return BGTZ; if (is_opcode(name, BGEZ)) return BGEZ; break;
+					}
+					break;
+			}
+			break;
+		case 5:
+			if (is_opcode(name, MULTS)) return MULTS;
+			break;
+	}
+	return NUM_ISA_OPCODES;
+}
+
+/* parses an assembler directive (region of interest markers) - "index" is the index of the next instruction */
+static void parse_directive(string_view directive, program_t *program, unsigned index){
+	if (directive == ".roi_begin") program->roi_begin = index;
+	else if (directive == ".roi_end") program->roi_end = index;
+	else {
+		cout << "ERROR: invalid directive: " << directive << " !" << endl;
+		exit(-1);
+	}
+}
+
+/* parses a register operand (e.g., "R3" or "F3") - exits with an error if its number does not fit in instruction_t */
+static unsigned char parse_register(string_view token){
+	size_t i = 0;
+	while (i < token.length() && (token[i] == 'R' || token[i] == 'F')) i++;
+	unsigned reg = 0;
+	for (; i < token.length() && token[i] >= '0' && token[i] <= '9' && reg < UNDEFINED_REGISTER; i++) reg = reg*10 + (token[i]-'0');
+	if (reg >= UNDEFINED_REGISTER){
+		cout << "ERROR: invalid register: " << token << " !" << endl;
+		exit(-1);
+	}
+	return reg;
+}
+
+/* parses an immediate operand - decimal, hexadecimal (0x prefix) or octal (0 prefix), as strtoul with base 0 */
+static unsigned parse_immediate(string_view token){
+	size_t i = 0;
+	bool negative = false;
+	if (i < token.length() && (token[i] == '-' || token[i] == '+')) negative = (token[i++] == '-');
+	unsigned base = 10;
+	if (i+1 < token.length() && token[i] == '0' && (token[i+1] == 'x' || token[i+1] == 'X')){
+		base = 16;
+		i += 2;
+	} else if (i+1 < token.length() && token[i] == '0'){
+		base = 8;
+	}
+	unsigned value = 0;
+	for (; i < token.length(); i++){
+		char c = token[i];
+		unsigned digit;
+		if (c >= '0' && c <= '9') digit = c - '0';
+		else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+		else break;
+		if (digit >= base) break;
+		value = value*base + digit;
+	}
+	return (negative ? -value : value);
+}
+
+/* parses a memory operand "<immediate>(<register>)" */
+static void parse_memory_operand(string_view token, unsigned &immediate, unsigned char &reg){
+	size_t paren = token.find('(');
+	immediate = parse_immediate(token.substr(0, paren));
+	reg = (paren == string_view::npos) ? 0 : parse_register(token.substr(paren+1));
+}
+
+/* returns the opcode with mnemonic "name" - exits with an error if it is not below "num_opcodes" (NUM_ISA_OPCODES if "name" is not an opcode at all) */
+static unsigned lookup_supported_opcode(string_view name, unsigned num_opcodes){
+	unsigned opcode = lookup_opcode(name);
+	if (opcode < NUM_ISA_OPCODES && opcode >= num_opcodes){
+		cout << "ERROR: opcode not supported by the simulator: " << name << " !" << endl;
+		exit(-1);
+	}
+	return opcode;
+}
+
+#define MAX_TOKENS 5 //label, opcode and up to three operands
+
+/* parses the assembly program in file "filename", and returns it */
+shared_ptr<const program_t> parse_program(const char *filename, unsigned num_opcodes){
+
+   program_t *program = new program_t();
+
+   /* mapping the assembly file in memory - lines are tokenized in place, without being copied */
+   int fd = open(filename, O_RDONLY);
+   struct stat file_stat;
+   if (fd < 0 || fstat(fd, &file_stat) < 0) {
+      cout << "ERROR: open file " << filename << " failed !" << endl;
+      exit(-1);
+   }
+   size_t size = file_stat.st_size;
+   const char *text = NULL;
+   if (size > 0){
+	text = (const char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (text == MAP_FAILED){
+		cout << "ERROR: mapping file " << filename << " failed !" << endl;
+		exit(-1);
+	}
+   }
+   close(fd);
+
+   /* labels of the branch operations (instruction number -> target label), resolved once all labels are known */
+   vector<pair<unsigned, string_view> > branch_labels;
+   program->storage.reserve(count(text, text+size, '\n') + 1);
+
+   /* parsing the assembly file line by line */
+   const char *line = text;
+   const char *end = text + size;
+   while (line < end){
+	const char *eol = (const char *) memchr(line, '\n', end - line);
+	if (eol == NULL) eol = end;
+
+  	// tokenize the instruction
+	string_view tokens[MAX_TOKENS];
+	unsigned num_tokens = 0;
+	for (const char *p = line; p < eol && num_tokens < MAX_TOKENS; ){
+		while (p < eol && is_separator(*p)) p++;
+		const char *start = p;
+		while (p < eol && !is_separator(*p)) p++;
+		if (p > start) tokens[num_tokens++] = string_view(start, p - start);
+	}
+	line = eol + 1;
+	if (num_tokens == 0) continue;
+
+	unsigned t = 0;
+	unsigned opcode = lookup_supported_opcode(tokens[t], num_opcodes);
+	if (opcode == NUM_ISA_OPCODES && tokens[t][0] != '.'){
+		// this is a label for a branch - extract it and save it in the symbol table
+		string_view label = tokens[t];
+		if (label.back() == ':') label.remove_suffix(1);
+		program->symbols[string(label)] = program->storage.size();
+                // move to next token, which must be the instruction opcode (or a directive)
+		if (++t == num_tokens) continue;
+		opcode = lookup_supported_opcode(tokens[t], num_opcodes);
+		if (opcode == NUM_ISA_OPCODES && tokens[t][0] != '.'){
+			cout << "ERROR: invalid opcode: " << tokens[t] << " !" << endl;
+			exit(-1);
+		}
+	}
+	if (opcode == NUM_ISA_OPCODES){
+		parse_directive(tokens[t], program, program->storage.size());
+		continue;
+	}
+	instruction_t instr = nop_instruction;
+	instr.opcode = (opcode_t) opcode;
+	instr.flags = instr_flags(instr.opcode);
+	if (num_tokens - t - 1 < num_operands(instr.opcode)){
+		cout << "ERROR: missing operand: " << tokens[t] << " !" << endl;
+		exit(-1);
+	}
+
+	//reading remaining parameters
+	string_view *par = tokens + t + 1;
+	switch(instr.opcode){
+		case ADD:
+		case SUB:
+		case XOR:
+		case ADDS:
+		case SUBS:
+		case MULTS:
+		case DIVS:
+			instr.dest = parse_register(par[0]);
+			instr.src1 = parse_register(par[1]);
+			instr.src2 = parse_register(par[2]);
+			break;
+		case ADDI:
+		case SUBI:
+			instr.dest = parse_register(par[0]);
+			instr.src1 = parse_register(par[1]);
+			instr.immediate = parse_immediate(par[2]);
+			break;
+		case LW:
+		case LWS:
+			instr.dest = parse_register(par[0]);
+			parse_memory_operand(par[1], instr.immediate, instr.src1);
+			break;
+		case SW:
+		case SWS:
+			instr.src2 = parse_register(par[0]);
+			parse_memory_operand(par[1], instr.immediate, instr.src1);
+			break;
+		case BEQZ:
+		case BNEZ:
+		case BLTZ:
+		case BGTZ:
+		case BLEZ:
+		case BGEZ:
+			instr.src1 = parse_register(par[0]);
+			branch_labels.push_back(make_pair((unsigned) program->storage.size(), par[1]));
+			break;
+		case JUMP:
+			branch_labels.push_back(make_pair((unsigned) program->storage.size(), par[0]));
+			break;
+		default:
+			break;
+
+	}
+	program->storage.push_back(instr);
+   }
+
+   //resolving the labels of the branch operations into absolute target indexes and PC-relative immediates
+   for (unsigned b=0; b<branch_labels.size(); b++){
+	map<string, unsigned, less<> >::iterator label = program->symbols.find(branch_labels[b].second);
+	if (label == program->symbols.end()){
+		cout << "ERROR: undefined label: " << branch_labels[b].second << " !" << endl;
+		exit(-1);
+	}
+	unsigned i = branch_labels[b].first;
+	program->storage[i].target = label->second;
+	program->storage[i].immediate = (label->second - i - 1) << 2;
+   }
+
+   if (text != NULL) munmap((void *) text, size);
+
+   program->instructions = program->storage.data();
+   program->num_instructions = program->storage.size();
+   return shared_ptr<const program_t>(program);
+}
+
+/* ===================== binary program image ======================== */
+
+/* reads the binary program image in file "filename" - the instructions are used in place from the mapped image */
+shared_ptr<const program_t> read_program_image(const char *filename, unsigned num_opcodes, unsigned num_registers){
+
+   /* mapping the image in memory */
+   int fd = open(filename, O_RDONLY);
+   struct stat file_stat;
+   if (fd < 0 || fstat(fd, &file_stat) < 0) {
+      cout << "ERROR: open file " << filename << " failed !" << endl;
+      exit(-1);
+   }
+   size_t size = file_stat.st_size;
+   const char *image = (size == 0) ? (const char *) MAP_FAILED : (const char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (image == MAP_FAILED || size < sizeof(program_image_header_t)){
+      cout << "ERROR: " << filename << " is not a valid program image !" << endl;
+      exit(-1);
+   }
+
+   /* validating the header */
+   const program_image_header_t *header = (const program_image_header_t *) image;
+   size_t instructions_offset = sizeof(program_image_header_t);
+   size_t symbols_offset = instructions_offset + (size_t) header->num_instructions * sizeof(instruction_t);
+   size_t strings_offset = symbols_offset + (size_t) header->num_symbols * sizeof(program_image_symbol_t);
+   if (header->magic != PROGRAM_IMAGE_MAGIC || header->version != PROGRAM_IMAGE_VERSION ||
+       header->instruction_size != sizeof(instruction_t) || strings_offset + header->string_table_size != size){
+      cout << "ERROR: " << filename << " is not a valid program image (version " << PROGRAM_IMAGE_VERSION << ") !" << endl;
+      exit(-1);
+   }
+
+   /* the decoded instructions are used directly from the image, which stays mapped as long as the program is in use */
+   program_t *program = new program_t();
+   program->image = image;
+   program->image_size = size;
+   program->instructions = (const instruction_t *) (image + instructions_offset);
+   program->num_instructions = header->num_instructions;
+   program->roi_begin = header->roi_begin;
+   program->roi_end = header->roi_end;
+   if ((program->roi_begin != UNDEFINED && program->roi_begin > program->num_instructions) ||
+       (program->roi_end != UNDEFINED && program->roi_end > program->num_instructions)){
+	cout << "ERROR: invalid region of interest in program image: " << program->roi_begin << " - " << program->roi_end << " !" << endl;
+	exit(-1);
+   }
+
+   /* validating the instructions: the simulators use them as they are, without further checks
+      (branch targets, as labels, can be the index just past the last instruction) */
+   for (unsigned i=0; i<program->num_instructions; i++){
+	const instruction_t &instr = program->instructions[i];
+	if (instr.opcode >= num_opcodes){
+		cout << "ERROR: invalid opcode in program image: " << (unsigned) instr.opcode << " !" << endl;
+		exit(-1);
+	}
+	if (instr.flags != instr_flags(instr.opcode)){
+		cout << "ERROR: invalid flags in program image: " << (unsigned) instr.flags << " (instruction " << i << ") !" << endl;
+		exit(-1);
+	}
+	if ((instr.src1 != UNDEFINED_REGISTER && instr.src1 >= num_registers) || (instr.src2 != UNDEFINED_REGISTER && instr.src2 >= num_registers) ||
+	    (instr.dest != UNDEFINED_REGISTER && instr.dest >= num_registers)){
+		cout << "ERROR: invalid register in program image (instruction " << i << ") !" << endl;
+		exit(-1);
+	}
+	if ((instr.flags & CLASS_BRANCH) && (instr.target > program->num_instructions || instr.immediate != (instr.target - i - 1) << 2)){
+		cout << "ERROR: invalid branch target in program image: " << instr.target << " (instruction " << i << ") !" << endl;
+		exit(-1);
+	}
+   }
+
+   /* rebuilding the symbol table */
+   const program_image_symbol_t *image_symbols = (const program_image_symbol_t *) (image + symbols_offset);
+   const char *strings = image + strings_offset;
+   for (unsigned s=0; s<header->num_symbols; s++){
+	const program_image_symbol_t &symbol = image_symbols[s];
+	size_t name_length = (symbol.name < header->string_table_size) ? strnlen(strings + symbol.name, header->string_table_size - symbol.name) : 0;
+	if (symbol.index > program->num_instructions || symbol.name >= header->string_table_size || symbol.name + name_length == header->string_table_size){
+		cout << "ERROR: invalid symbol in program image: " << s << " !" << endl;
+		exit(-1);
+	}
+	program->symbols[string(strings + symbol.name, name_length)] = symbol.index;
+   }
+
+   return shared_ptr<const program_t>(program);
+}
+
+/* writes the program as a binary program image in file "filename" */
+void write_program_image(const program_t &program, const char *filename){
+
+   /* building the symbol and string tables */
+   vector<program_image_symbol_t> image_symbols;
+   string strings;
+   for (map<string, unsigned, less<> >::const_iterator it = program.symbols.begin(); it != program.symbols.end(); it++){
+	program_image_symbol_t symbol = {it->second, (unsigned) strings.size()};
+	image_symbols.push_back(symbol);
+	strings.append(it->first);
+	strings.push_back('\0');
+   }
+
+   program_image_header_t header;
+   header.magic = PROGRAM_IMAGE_MAGIC;
+   header.version = PROGRAM_IMAGE_VERSION;
+   header.instruction_size = sizeof(instruction_t);
+   header.num_instructions = program.num_instructions;
+   header.num_symbols = image_symbols.size();
+   header.string_table_size = strings.size();
+   header.roi_begin = program.roi_begin;
+   header.roi_end = program.roi_end;
+
+   /* writing the image */
+   FILE *fout = fopen(filename, "wb");
+   if (fout == NULL) {
+      cout << "ERROR: open file " << filename << " failed !" << endl;
+      exit(-1);
+   }
+   bool ok = fwrite(&header, sizeof(header), 1, fout) == 1;
+   ok = ok && fwrite(program.instructions, sizeof(instruction_t), program.num_instructions, fout) == program.num_instructions;
+   ok = ok && fwrite(image_symbols.data(), sizeof(program_image_symbol_t), image_symbols.size(), fout) == image_symbols.size();
+   ok = ok && fwrite(strings.data(), 1, strings.size(), fout) == strings.size();
+   if (fclose(fout) != 0 || !ok) {
+      cout << "ERROR: write file " << filename << " failed !" << endl;
+      exit(-1);
+   }
+}
+
+/* creates an empty program */
+program_t::program_t(){
+   instructions = NULL;
+   num_instructions = 0;
+   roi_begin = UNDEFINED;
+   roi_end = UNDEFINED;
+   image = NULL;
+   image_size = 0;
+}
+
+/* releases the storage of the program - unmapping the binary program image, if any */
+program_t::~program_t(){
+   if (image != NULL) munmap((void *) image, image_size);
+}
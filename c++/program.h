@@ -0,0 +1,110 @@
+#ifndef PROGRAM_H_
+#define PROGRAM_H_
+
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+#define UNDEFINED 0xFFFFFFFF //used to initialize the registers
+#define UNDEFINED_REGISTER 0xFF //register field not used by an instruction (see instruction_t)
+
+/*
+Instruction set, shared by the simulators and the assembler: the integer pipeline (sim_pipe) implements the opcodes
+up to NOP, the floating point pipeline (sim_pipe_fp) all of them - each simulator defines its NUM_OPCODES, and
+rejects programs using the opcodes beyond it.
+*/
+typedef enum : unsigned char {LW, SW, ADD, ADDI, SUB, SUBI, XOR, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, NOP, LWS, SWS, ADDS, SUBS, MULTS, DIVS} opcode_t;
+
+#define NUM_ISA_OPCODES 22
+
+/* instruction class flags (see instruction_t.flags) */
+#define CLASS_BRANCH  0x01 //conditional branch or jump
+#define CLASS_MEMORY  0x02 //load or store (integer or floating point)
+#define CLASS_LOAD    0x04 //load (LW, LWS)
+#define CLASS_STORE   0x08 //store (SW, SWS)
+#define CLASS_INT_R   0x10 //integer register-register operation
+#define CLASS_INT_IMM 0x20 //integer register-immediate operation
+#define CLASS_FP_ALU  0x40 //floating point operation (ADDS, SUBS, MULTS, DIVS)
+#define CLASS_FP      0x80 //accesses the floating point register file (LWS, SWS and floating point operations)
+
+typedef struct{
+        opcode_t opcode; //opcode
+        unsigned char flags; //instruction class flags (CLASS_*), precomputed at load time
+        unsigned char src1; //source register #1 - see the instruction encoding of the simulators (UNDEFINED_REGISTER if not used)
+        unsigned char src2; //source register #2 - see the instruction encoding of the simulators (UNDEFINED_REGISTER if not used)
+        unsigned char dest; //destination register (UNDEFINED_REGISTER if not used)
+        unsigned immediate; //immediate field
+        unsigned target; //for branches/jumps, index of the target instruction in instruction memory (resolved at load time)
+} instruction_t;
+
+//instruction memory and the binary program images are arrays of instruction_t: four instructions per 64-byte cache line
+static_assert(sizeof(instruction_t) == 16, "instruction_t is expected to take 16 bytes");
+
+/*
+Binary program image (written by write_program_image, read by read_program_image):
+- header (program_image_header_t)
+- instructions: num_instructions x instruction_t, already decoded and with branch targets resolved
+- symbol table: num_symbols x program_image_symbol_t
+- string table: string_table_size bytes of NUL-terminated labels
+All fields are stored in the native (little-endian) byte order.
+*/
+#define PROGRAM_IMAGE_MAGIC 0x50584C44 //"DLXP"
+#define PROGRAM_IMAGE_VERSION 3
+
+typedef struct{
+        unsigned magic; //PROGRAM_IMAGE_MAGIC
+        unsigned version; //PROGRAM_IMAGE_VERSION
+        unsigned instruction_size; //sizeof(instruction_t) of the assembler which wrote the image
+        unsigned num_instructions; //number of instructions
+        unsigned num_symbols; //number of entries in the symbol table
+        unsigned string_table_size; //size of the string table (in bytes)
+        unsigned roi_begin; //region of interest (see program_t)
+        unsigned roi_end;
+} program_image_header_t;
+
+typedef struct{
+        unsigned index; //instruction index the label refers to
+        unsigned name; //offset of the label in the string table
+} program_image_symbol_t;
+
+/*
+Decoded program: instructions and symbol table.
+A program is immutable once built (see parse_program/read_program_image), and can be attached to several
+simulator instances at the same time (see attach_program): it is released when the last one detaches.
+*/
+class program_t{
+public:
+        const instruction_t *instructions; //decoded instructions
+        unsigned num_instructions; //number of instructions
+        map<string, unsigned, less<> > symbols; //symbol table (label -> instruction index) - used only for parsing/debugging purposes
+        unsigned roi_begin; //index of the first instruction of the region of interest (UNDEFINED if there is no .roi_begin directive)
+        unsigned roi_end; //index of the first instruction after the region of interest (UNDEFINED if there is no .roi_end directive)
+
+        vector<instruction_t> storage; //storage of the instructions of programs parsed from assembly
+        const void *image; //binary program image the instructions are used from (NULL if the program was parsed from assembly)
+        size_t image_size; //size of the binary program image
+
+        program_t();
+        ~program_t();
+        program_t(const program_t &) = delete;
+        program_t &operator=(const program_t &) = delete;
+};
+
+//parses the assembly program in file "filename", whose opcodes have to be below "num_opcodes" (see opcode_t)
+//exits with an error if the file cannot be read, or if the program is not valid
+shared_ptr<const program_t> parse_program(const char *filename, unsigned num_opcodes);
+
+//reads the binary program image in file "filename" (the instructions are used in place from the mapped image),
+//whose opcodes have to be below "num_opcodes" and registers below "num_registers" (in each register file)
+//exits with an error if the file cannot be read, or if the image is not valid: wrong header or size, opcodes or flags not
+//matching the instruction set, registers, branch targets, symbols (instruction index or name not NUL-terminated in the
+//string table) or region of interest out of range
+shared_ptr<const program_t> read_program_image(const char *filename, unsigned num_opcodes, unsigned num_registers);
+
+//writes "program" as a binary program image in file "filename" - exits with an error if the file cannot be written
+void write_program_image(const program_t &program, const char *filename);
+
+#endif /*PROGRAM_H_*/
@@ -4,11 +4,13 @@ Email: tutorcs@163.com
 #include "sim_pipe.h"
 #include <stdlib.h>
 #include <iostream>
-#include <fstream>
 #include <cstring>
 #include <string>
 #include <iomanip>
 #include <map>
+#include <vector>
+#include <memory>
+#include <algorithm>
 
 //#define DEBUG
 
@@ -17,7 +19,12 @@ using namespace std;
 //used for debugging purposes
 static const char *reg_names[NUM_SP_REGISTERS] = {"PC", "NPC", "IR", "A", "B", "IMM", "COND", "ALU_OUTPUT", "LMD"};
 static const char *stage_names[NUM_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
-static const char *instr_names[NUM_OPCODES] = {"LW", "SW", "ADD", "ADDI", "SUB", "SUBI", "XOR", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "JUMP", "EOP", "NOP"};
+
+//empty instruction slot
+static const instruction_t nop_instruction = {NOP, 0, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED, UNDEFINED};
+
+//end of the program (returned by fetch_instruction at the end of the region of interest)
+static const instruction_t eop_instruction = {EOP, 0, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED, UNDEFINED};
 
 /* =============================================================
 
@@ -96,150 +103,209 @@ bool taken_branch(opcode_t opcode, unsigned a){
         return false;
 }
 
-/* return the kind of instruction encoded */ 
+/* =============================================================
 
-bool is_branch(opcode_t opcode){
-        return (opcode == BEQZ || opcode == BNEZ || opcode == BLTZ || opcode == BLEZ || opcode == BGTZ || opcode == BGEZ || opcode == JUMP);
-}
+   CODE PROVIDED - NO NEED TO MODIFY FUNCTIONS BELOW
+
+   ============================================================= */
 
-bool is_memory(opcode_t opcode){
-        return (opcode == LW || opcode == SW);
+/* parses the assembly program in file "filename", and returns it (see attach_program) */
+shared_ptr<const program_t> sim_pipe::read_program(const char *filename){
+   return parse_program(filename, NUM_OPCODES);
 }
 
-bool is_int_r(opcode_t opcode){
-        return (opcode == ADD || opcode == SUB || opcode == XOR);
+/* loads the assembly program in file "filename" in instruction memory at the specified address */
+void sim_pipe::load_program(const char *filename, unsigned base_address){
+   attach_program(read_program(filename), base_address);
 }
 
-bool is_int_imm(opcode_t opcode){
-        return (opcode == ADDI || opcode == SUBI);
+/* reads the binary program image in file "filename" (see save_binary) - the instructions are used in place from the mapped image */
+shared_ptr<const program_t> sim_pipe::read_binary(const char *filename){
+   return read_program_image(filename, NUM_OPCODES, NUM_GP_REGISTERS);
 }
 
-/* =============================================================
+/* loads the binary program image in file "filename" (see save_binary) in instruction memory at the specified address */
+void sim_pipe::load_binary(const char *filename, unsigned base_address){
+   attach_program(read_binary(filename), base_address);
+}
 
-   CODE PROVIDED - NO NEED TO MODIFY FUNCTIONS BELOW
+/* saves the program currently in instruction memory as a binary program image in file "filename" */
+void sim_pipe::save_binary(const char *filename){
 
-   ============================================================= */
+   if (program == NULL) {
+      cerr << "error: no program loaded in instruction memory!" << endl;
+      exit(-1);
+   }
 
-/* loads the assembly program in file "filename" in instruction memory at the specified address */
-void sim_pipe::load_program(const char *filename, unsigned base_address){
+   write_program_image(*program, filename);
+}
 
-   /* initializing the base instruction address */
+/* attaches the (shared, read-only) program "program" to instruction memory at the specified address */
+void sim_pipe::attach_program(shared_ptr<const program_t> program, unsigned base_address){
+   this->program = program;
+   instr_memory = program->instructions;
+   instr_memory_size = program->num_instructions;
    instr_base_address = base_address;
+   functional_pc = base_address;
+   sp_registers[IF][0][PC] = base_address;
+}
 
-   /* creating a map with the valid opcodes and with the valid labels */
-   map<string, opcode_t> opcodes; //for opcodes
-   map<string, unsigned> labels;  //for branches
-   for (int i=0; i<NUM_OPCODES; i++)
-	 opcodes[string(instr_names[i])]=(opcode_t)i;
-
-   /* opening the assembly file */
-   ifstream fin(filename, ios::in | ios::binary);
-   if (!fin.is_open()) {
-      cerr << "error: open file " << filename << " failed!" << endl;
-      exit(-1);
-   }
+/* returns the program currently in instruction memory (NULL if no program is loaded) */
+shared_ptr<const program_t> sim_pipe::get_program(){
+   return program;
+}
 
-   /* parsing the assembly file line by line */
-   string line;
-   unsigned instruction_nr = 0;
-   while (getline(fin,line)){
-	// set the instruction field
-	char *str = const_cast<char*>(line.c_str());
-
-  	// tokenize the instruction
-	char *token = strtok (str," \t");
-	map<string, opcode_t>::iterator search = opcodes.find(token);
-        if (search == opcodes.end()){
-		// this is a label for a branch - extract it and save it in the labels map
-		string label = string(token).substr(0, string(token).length() - 1);
-		labels[label]=instruction_nr;
-                // move to next token, which must be the instruction opcode
-		token = strtok (NULL, " \t");
-		search = opcodes.find(token);
-		if (search == opcodes.end()) cout << "ERROR: invalid opcode: " << token << " !" << endl;
+/* returns the instruction at address "pc" in instruction memory - a NOP if "pc" falls outside the loaded program, EOP at the end of the region of interest simulated in detail */
+const instruction_t &sim_pipe::fetch_instruction(unsigned pc){
+	if (pc == roi_end_pc){
+		roi_end_fetched = true;
+		return eop_instruction;
 	}
-	instr_memory[instruction_nr].opcode = search->second;
-
-	//reading remaining parameters
-	char *par1;
-	char *par2;
-	char *par3;
-	switch(instr_memory[instruction_nr].opcode){
-		case ADD:
-		case SUB:
-		case XOR:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			par3 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "R"));
-			instr_memory[instruction_nr].src2 = atoi(strtok(par3, "R"));
-			break;
-		case ADDI:
-		case SUBI:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			par3 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "R"));
-			instr_memory[instruction_nr].immediate = strtoul (par3, NULL, 0); 
-			break;
-		case LW:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
-			instr_memory[instruction_nr].src1 = atoi(strtok(NULL, "R"));
-			break;
-		case SW:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].src2 = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
-			instr_memory[instruction_nr].src1 = atoi(strtok(NULL, "R"));
-			break;
-		case BEQZ:
-		case BNEZ:
-		case BLTZ:
-		case BGTZ:
-		case BLEZ:
-		case BGEZ:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].src1 = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].label = par2;
-			break;
-		case JUMP:
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].label = par2;
-		default:
-			break;
+	unsigned index = (pc-instr_base_address)>>2;
+	if (pc < instr_base_address || index >= instr_memory_size) return nop_instruction;
+	if (instr_memory[index].opcode == EOP) roi_end_fetched = false;
+	return instr_memory[index];
+}
 
-	} 
+/* returns the number of clock cycles taken by a data memory access (data_memory_latency if no data caches are configured) */
+unsigned sim_pipe::data_memory_access_latency(unsigned address, bool is_write){
+	return data_memory_hierarchy.access(address, is_write);
+}
 
-	/* increment instruction number before moving to next line */
-	instruction_nr++;
-   }
-   //reconstructing the labels of the branch operations
-   int i = 0;
-   while(true){
-   	instruction_t instr = instr_memory[i];
-	if (instr.opcode == EOP) break;
-	if (instr.opcode == BLTZ || instr.opcode == BNEZ ||
-            instr.opcode == BGTZ || instr.opcode == BEQZ ||
-            instr.opcode == BGEZ || instr.opcode == BLEZ ||
-            instr.opcode == JUMP
-	 ){
-		instr_memory[i].immediate = (labels[instr.label] - i - 1) << 2;
-	}
-        i++;
-   }
+/* issues a data memory access in the current clock cycle - returns its completion cycle, or UNDEFINED if it cannot be issued */
+unsigned sim_pipe::data_memory_issue(unsigned address, bool is_write, unsigned pc){
+	unsigned ready_cycle = data_memory_hierarchy.issue(address, is_write, clock_cycles, pc);
+	return (ready_cycle == NOT_ISSUED) ? UNDEFINED : ready_cycle;
+}
+
+/* returns the PC from which to fetch after an instruction */
+unsigned sim_pipe::predict_next_pc(unsigned pc, const instruction_t &instruction){
+	if (!(instruction.flags & CLASS_BRANCH) || !predictor.is_enabled()) return pc + 4;
+	return predictor.predict(pc, pc + 4 + instruction.immediate, instruction.opcode == JUMP);
+}
+
+/* updates the branch predictor with a resolved branch, squashing the younger instructions if it was mispredicted */
+bool sim_pipe::resolve_branch(unsigned pc, bool taken, unsigned target, unsigned predicted_pc, stage_t stage){
+	if (!predictor.is_enabled()) return false;
+	if (!predictor.update(pc, taken, target, fetch_instruction(pc).opcode == JUMP, predicted_pc)) return false;
+	for (unsigned i=IF; i+1<(unsigned)stage; i++)
+		for (unsigned w=0; w<issue_width; w++) ir[i][w] = nop_instruction;
+	mispredict_penalty += stage - 1; //one clock cycle for each squashed pipeline register
+	return true;
+}
 
+/* fetches the group of instructions starting at "pc", which can proceed together through the pipeline */
+unsigned sim_pipe::fetch_group(unsigned pc, instruction_t *group, unsigned &next_pc){
+	unsigned size = 0, alus = 0, memory_accesses = 0;
+	next_pc = pc;
+	while (size < issue_width){
+		const instruction_t &instr = fetch_instruction(next_pc);
+		// instructions using an ALU and a data memory port (all but NOP and EOP use the ALU, for the address computation of loads and stores)
+		bool uses_alu = (instr.opcode != NOP && instr.opcode != EOP);
+		bool uses_memory = (instr.flags & CLASS_MEMORY);
+		bool dependent = false;
+		for (unsigned i=0; i<size && !dependent; i++){
+			if (group[i].dest == UNDEFINED_REGISTER) continue;
+			dependent = (instr.src1 == group[i].dest || instr.src2 == group[i].dest || instr.dest == group[i].dest);
+		}
+		if (dependent){ group_splits[SPLIT_DEPENDENCY]++; break; }
+		if (uses_alu && alus == num_alus){ group_splits[SPLIT_ALU]++; break; }
+		if (uses_memory && memory_accesses == memory_ports){ group_splits[SPLIT_MEMORY_PORT]++; break; }
+		// EOP is fetched alone in its group (the simulation ends when it reaches WB), and the fetch does not go beyond it
+		if (instr.opcode == EOP && size > 0) break;
+		group[size++] = instr;
+		alus += uses_alu;
+		memory_accesses += uses_memory;
+		if (instr.opcode == EOP) break;
+		next_pc = predict_next_pc(next_pc, instr);
+		if (instr.flags & CLASS_BRANCH){
+			if (size < issue_width) group_splits[SPLIT_BRANCH]++;
+			break;
+		}
+	}
+	return size;
 }
 
 /* writes an integer value to data memory at the specified address (use little-endian format: https://en.wikipedia.org/wiki/Endianness) */
 void sim_pipe::write_memory(unsigned address, unsigned value){
-	int2char(value,data_memory+address);
+	data_memory.write_word(address, value);
+}
+
+/* reads an integer value from data memory at the specified address (little-endian format) */
+unsigned sim_pipe::read_memory(unsigned address){
+	return data_memory.read_word(address);
+}
+
+/* writes "size" bytes from "data" to data memory, starting at the specified address */
+void sim_pipe::write_memory_block(unsigned address, const unsigned char *data, unsigned size){
+	data_memory.write_block(address, data, size);
+}
+
+/* loads the memory image in file "filename" in data memory at the specified address */
+void sim_pipe::load_memory_image(const char *filename, unsigned base_address){
+	if (!data_memory.load_image(filename, base_address)){
+		cerr << "error: loading memory image " << filename << " failed!" << endl;
+		exit(-1);
+	}
+}
+
+/* adds a data cache level in front of data memory */
+void sim_pipe::init_cache(cache_level_t level, unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency, replacement_policy_t replacement, write_policy_t write_policy){
+	data_memory_hierarchy.configure_cache(level, size, associativity, line_size, hit_latency, replacement, write_policy);
+}
+
+/* makes the L1 data cache non-blocking, with "num_mshrs" MSHRs */
+void sim_pipe::init_mshrs(unsigned num_mshrs){
+	data_memory_hierarchy.configure_mshrs(num_mshrs);
+}
+
+/* replaces the fixed data memory latency with a DRAM model */
+void sim_pipe::init_dram(unsigned num_banks, unsigned row_size, unsigned row_hit_latency, unsigned row_miss_latency, unsigned row_conflict_latency){
+	data_memory_hierarchy.configure_dram(num_banks, row_size, row_hit_latency, row_miss_latency, row_conflict_latency);
+}
+
+/* adds a stride prefetcher to the L1 data cache */
+void sim_pipe::init_prefetcher(unsigned table_size, unsigned degree){
+	data_memory_hierarchy.configure_prefetcher(table_size, degree);
+}
+
+/* adds a store buffer in front of the data caches */
+void sim_pipe::init_store_buffer(unsigned num_entries){
+	data_memory_hierarchy.configure_store_buffer(num_entries);
+}
+
+/* sets the forwarding network */
+void sim_pipe::init_forwarding(forwarding_t forwarding){
+	this->forwarding.configure(forwarding);
+}
+
+/* enables or disables the skipping of idle clock cycles */
+void sim_pipe::init_cycle_skipping(bool enabled){
+	cycle_skipping = enabled;
+}
+
+/* makes the pipeline superscalar */
+void sim_pipe::init_superscalar(unsigned width, unsigned alus, unsigned ports){
+	if (alus == 0) alus = width;
+	if (width == 0 || width > MAX_ISSUE_WIDTH || alus > width || ports == 0 || ports > width){
+		cerr << "error: invalid superscalar configuration (issue_width=" << width << " num_alus=" << alus << " memory_ports=" << ports << ")!" << endl;
+		exit(-1);
+	}
+	if (clock_cycles != 0){
+		cerr << "error: the issue width cannot be changed once the simulation has started!" << endl;
+		exit(-1);
+	}
+	issue_width = width;
+	num_alus = alus;
+	memory_ports = ports;
+}
+
+/* adds a dynamic branch predictor to the IF stage */
+void sim_pipe::init_branch_predictor(predictor_t type, unsigned table_size, unsigned history_bits, unsigned btb_size){
+	if (!predictor.configure(type, table_size, history_bits, btb_size)){
+		cerr << "error: invalid branch predictor configuration (table_size=" << table_size << " history_bits=" << history_bits << " btb_size=" << btb_size << ")!" << endl;
+		exit(-1);
+	}
 }
 
 /* prints the content of the data memory within the specified address range */
@@ -247,7 +313,7 @@ void sim_pipe::print_memory(unsigned start_address, unsigned end_address){
 	cout << "data_memory[0x" << hex << setw(8) << setfill('0') << start_address << ":0x" << hex << setw(8) << setfill('0') <<  end_address << "]" << endl;
 	for (unsigned i=start_address; i<end_address; i++){
 		if (i%4 == 0) cout << "0x" << hex << setw(8) << setfill('0') << i << ": "; 
-		cout << hex << setw(2) << setfill('0') << int(data_memory[i]) << " ";
+		cout << hex << setw(2) << setfill('0') << int(data_memory.read_byte(i)) << " ";
 		if (i%4 == 3) cout << endl;
 	} 
 }
@@ -270,13 +336,16 @@ void sim_pipe::print_registers(){
 sim_pipe::sim_pipe(unsigned mem_size, unsigned mem_latency){
 	data_memory_size = mem_size;
 	data_memory_latency = mem_latency;
-	data_memory = new unsigned char[data_memory_size];
+	data_memory_hierarchy.set_memory_latency(mem_latency);
+	cycle_skipping = true;
+	issue_width = 1;
+	num_alus = 1;
+	memory_ports = 1;
 	reset();
 }
 	
 /* deallocates the pipeline simulator */
 sim_pipe::~sim_pipe(){
-	delete [] data_memory;
 }
 
 /* execution statistics */
@@ -284,8 +353,57 @@ unsigned sim_pipe::get_clock_cycles(){return clock_cycles;}
 
 unsigned sim_pipe::get_instructions_executed(){return instructions_executed;}
 
+unsigned sim_pipe::get_functional_instructions(){return functional_instructions;}
+
 unsigned sim_pipe::get_stalls(){return stalls;}
 
+unsigned sim_pipe::get_skipped_cycles(){return skipped_cycles;}
+
+unsigned sim_pipe::get_cache_hits(cache_level_t level){return data_memory_hierarchy.get_cache_stats(level).hits;}
+
+unsigned sim_pipe::get_cache_misses(cache_level_t level){return data_memory_hierarchy.get_cache_stats(level).misses;}
+
+unsigned sim_pipe::get_cache_evictions(cache_level_t level){return data_memory_hierarchy.get_cache_stats(level).evictions;}
+
+float sim_pipe::get_memory_level_parallelism(){return data_memory_hierarchy.get_memory_level_parallelism();}
+
+unsigned sim_pipe::get_merged_misses(){return data_memory_hierarchy.get_mshr_stats().secondary_misses;}
+
+unsigned sim_pipe::get_mshr_full_stalls(){return data_memory_hierarchy.get_mshr_stats().mshr_full;}
+
+unsigned sim_pipe::get_dram_row_hits(){return data_memory_hierarchy.get_dram_stats().row_hits;}
+
+unsigned sim_pipe::get_dram_row_misses(){return data_memory_hierarchy.get_dram_stats().row_misses;}
+
+unsigned sim_pipe::get_dram_row_conflicts(){return data_memory_hierarchy.get_dram_stats().row_conflicts;}
+
+float sim_pipe::get_prefetch_accuracy(){return data_memory_hierarchy.get_prefetch_accuracy();}
+
+float sim_pipe::get_prefetch_coverage(){return data_memory_hierarchy.get_prefetch_coverage();}
+
+float sim_pipe::get_prefetch_timeliness(){return data_memory_hierarchy.get_prefetch_timeliness();}
+
+unsigned sim_pipe::get_forwarded_loads(){return data_memory_hierarchy.get_store_buffer_stats().forwarded_loads;}
+
+unsigned sim_pipe::get_store_buffer_full_stalls(){return data_memory_hierarchy.get_store_buffer_stats().full_stalls;}
+
+unsigned sim_pipe::get_forwarded_operands(forwarding_path_t path){return forwarding.get_forwarded_operands(path);}
+
+unsigned sim_pipe::get_forwarding_saved_stalls(forwarding_path_t path){return forwarding.get_saved_stalls(path);}
+
+float sim_pipe::get_branch_prediction_accuracy(){
+	const branch_stats_t &stats = predictor.get_stats();
+	return (stats.branches == 0) ? 0 : 1 - (float)stats.mispredictions/stats.branches;
+}
+
+unsigned sim_pipe::get_branch_mispredictions(){return predictor.get_stats().mispredictions;}
+
+unsigned sim_pipe::get_branch_mispredict_penalty(){return mispredict_penalty;}
+
+unsigned sim_pipe::get_btb_misses(){return predictor.get_stats().btb_misses;}
+
+unsigned sim_pipe::get_group_splits(group_split_t reason){return group_splits[reason];}
+
 float sim_pipe::get_IPC(){return (float)instructions_executed/clock_cycles;}
                                 
 /* =============================================================
@@ -298,56 +416,176 @@ float sim_pipe::get_IPC(){return (float)instructions_executed/clock_cycles;}
 /* reset the state of the pipeline simulator */
 void sim_pipe::reset(){
 
-	// initializing data memory to all 0xFF
-	for (unsigned i=0; i<data_memory_size; i++) data_memory[i]=0xFF;
+	// initializing data memory to all 0xFF (in O(1), see paged_memory::reset)
+	data_memory.reset();
+
+	// emptying the data caches (their configuration is preserved)
+	data_memory_hierarchy.reset();
+
+	// clearing the forwarding statistics (the forwarding network is preserved)
+	forwarding.reset();
+
+	// emptying the branch predictor (its configuration is preserved)
+	predictor.reset();
+	mispredict_penalty = 0;
+
+	// clearing the statistics of the fetch groups (the issue width is preserved)
+	for (unsigned r=0; r<NUM_GROUP_SPLITS; r++) group_splits[r] = 0;
 
 	// initializing instuction memory
-        for (int i=0; i<PROGRAM_SIZE;i++){
-                instr_memory[i].opcode=(opcode_t)NOP;
-                instr_memory[i].src1=UNDEFINED;
-                instr_memory[i].src2=UNDEFINED;
-                instr_memory[i].dest=UNDEFINED;
-                instr_memory[i].immediate=UNDEFINED;
-        }
+	program.reset();
+	instr_memory = NULL;
+	instr_memory_size = 0;
 	instr_base_address = UNDEFINED;
+	functional_pc = UNDEFINED;
+	functional_instructions = 0;
+	roi_end_pc = UNDEFINED;
+	roi_end_fetched = false;
 
 	// general purpose registers initialization
-	// <TODO: add initialization code here>
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++) gp_registers[r] = UNDEFINED;
 
 	// pipeline registers initialization
-	// <TODO: add initialization code here>
+	for (int s=0; s<NUM_STAGES; s++)
+		for (int w=0; w<MAX_ISSUE_WIDTH; w++)
+			for (int r=0; r<NUM_SP_REGISTERS; r++) sp_registers[s][w][r] = UNDEFINED;
+	for (int w=0; w<MAX_ISSUE_WIDTH; w++) memory_ready_cycle[w] = UNDEFINED;
 
 	// IR initialization
 	for (int i=0; i<NUM_STAGES-1; i++){
-		ir[i].opcode=(opcode_t)NOP;
-		ir[i].src1=UNDEFINED;
-		ir[i].src2=UNDEFINED;
-		ir[i].dest=UNDEFINED;
-		ir[i].immediate=UNDEFINED;
+		for (int w=0; w<MAX_ISSUE_WIDTH; w++){
+			ir[i][w].opcode=(opcode_t)NOP;
+			ir[i][w].src1=UNDEFINED_REGISTER;
+			ir[i][w].src2=UNDEFINED_REGISTER;
+			ir[i][w].dest=UNDEFINED_REGISTER;
+			ir[i][w].immediate=UNDEFINED;
+			ir[i][w].target=UNDEFINED;
+			ir[i][w].flags=0;
+			ir_pc[i][w]=UNDEFINED;
+			predicted_pc[i][w]=UNDEFINED;
+		}
 	}
 
 	// other required initializations (statistics, etc.)
 	clock_cycles = 0; //clock cycles
 	stalls = 0; //stalls
 	instructions_executed = 0; //instruction count
+	skipped_cycles = 0;
 }
 
 //returns value of special purpose register (see sim_pipe.h for more details)
 unsigned sim_pipe::get_sp_register(sp_register_t reg, stage_t s){
-	return 0; // <TODO: please modify>
+	return sp_registers[s][0][reg];
 }
 
 //returns value of general purpose register
 int sim_pipe::get_gp_register(unsigned reg){
-	return 0; // <TODO: please modify>
+	return gp_registers[reg];
 }
 
 //sets the value of referenced general purpose register
 void sim_pipe::set_gp_register(unsigned reg, int value){
-	 // <TODO: please modify>
+	gp_registers[reg] = value;
+}
+
+/* executes instructions functionally (architecturally, without modeling the pipeline), stopping after "instructions" instructions (if not 0), before EOP, or before "stop_pc" */
+unsigned sim_pipe::execute_functional(unsigned instructions, unsigned stop_pc){
+	// architectural state: the registers are copied in from (and back to) the simulator
+	unsigned regs[NUM_GP_REGISTERS];
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++) regs[r] = get_gp_register(r);
+
+	unsigned pc = functional_pc;
+	unsigned executed = 0;
+	while ((instructions == 0 || executed != instructions) && pc != stop_pc){
+		const instruction_t &instr = fetch_instruction(pc);
+		if (instr.opcode == EOP) break;
+		unsigned npc = pc + 4;
+		if (instr.flags & CLASS_INT_R){
+			regs[instr.dest] = alu(instr.opcode, regs[instr.src1], regs[instr.src2], instr.immediate, npc);
+		} else if (instr.flags & CLASS_INT_IMM){
+			regs[instr.dest] = alu(instr.opcode, regs[instr.src1], 0, instr.immediate, npc);
+		} else if (instr.flags & CLASS_LOAD){
+			regs[instr.dest] = read_memory(alu(instr.opcode, regs[instr.src1], 0, instr.immediate, npc));
+		} else if (instr.flags & CLASS_STORE){
+			write_memory(alu(instr.opcode, regs[instr.src1], 0, instr.immediate, npc), regs[instr.src2]);
+		} else if (instr.flags & CLASS_BRANCH){
+			if (taken_branch(instr.opcode, regs[instr.src1])) npc = alu(instr.opcode, regs[instr.src1], 0, instr.immediate, npc);
+		}
+		pc = npc;
+		executed++;
+	}
+
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++) set_gp_register(r, regs[r]);
+	functional_pc = pc;
+	functional_instructions += executed;
+	return executed;
 }
 
-/* <TODO: BODY OF THE SIMULATOR */
+/* executes "instructions" instructions functionally (up to EOP if instructions=0) */
+unsigned sim_pipe::run_functional(unsigned instructions){
+	return execute_functional(instructions, UNDEFINED);
+}
+
+/* runs the program, simulating in detail only its region of interest */
+void sim_pipe::run_roi(){
+	if (program == NULL){
+		cerr << "error: no program loaded in instruction memory!" << endl;
+		exit(-1);
+	}
+
+	// fast-forward to the beginning of the region of interest
+	if (program->roi_begin != UNDEFINED) execute_functional(0, instr_base_address + (program->roi_begin << 2));
+
+	// detailed simulation of the region of interest, which ends with an EOP in place of .roi_end
+	if (program->roi_end != UNDEFINED) roi_end_pc = instr_base_address + (program->roi_end << 2);
+	roi_end_fetched = false;
+	run();
+	roi_end_pc = UNDEFINED;
+
+	// functional execution of the rest of the program, unless run() has stopped at the actual end of the program
+	// (e.g., a branch leaving the region of interest)
+	if (roi_end_fetched){
+		functional_pc = instr_base_address + (program->roi_end << 2);
+		execute_functional(0, UNDEFINED);
+	}
+}
+
+/* returns the PC of the next instruction to be executed after run_functional */
+unsigned sim_pipe::get_functional_pc(){
+	return functional_pc;
+}
+
+/* skips "n" idle clock cycles (at most the ones left in the current run(cycles) invocation) */
+void sim_pipe::skip_idle_cycles(unsigned n, unsigned cycles, unsigned start_cycles){
+	if (cycles != 0) n = min(n, cycles - (clock_cycles - start_cycles));
+	clock_cycles += n;
+	stalls += n;
+	skipped_cycles += n;
+}
+
+/* returns the value of register "reg" for the instruction entering EXE, with forwarding */
+unsigned sim_pipe::forwarded_operand(unsigned reg, unsigned value){
+	if (reg == UNDEFINED_REGISTER) return value;
+	// EX/MEM -> EX: the producer has just moved on to MEM/WB (the instructions of a group write different registers)
+	for (unsigned w=0; w<issue_width; w++){
+		const instruction_t &producer = ir[WB-1][w];
+		if (producer.dest == reg) return (producer.flags & CLASS_LOAD) ? sp_registers[WB][w][LMD] : sp_registers[WB][w][ALU_OUTPUT];
+	}
+	// MEM/WB -> EX, or no hazard: WB has just written the register file
+	return gp_registers[reg];
+}
+
+/* empties the special purpose registers of a pipeline register slot (bubble) */
+static void clear_sp_registers(unsigned *registers){
+	for (unsigned r=0; r<NUM_SP_REGISTERS; r++) registers[r] = UNDEFINED;
+}
+
+/* BODY OF THE SIMULATOR */
+/*
+Each pipeline register holds a group of up to issue_width instructions (one per slot, see fetch_group): the group proceeds
+through the stages as a whole, and stalls as a whole if any of its instructions stalls (stalls are counted once per group).
+EOP is fetched alone in its group.
+*/
 // Note: processing the stages in reverse order simplifies the data propagation through pipeline registers
 void sim_pipe::run(unsigned cycles){
 
@@ -355,34 +593,180 @@ void sim_pipe::run(unsigned cycles){
 
 	/* initialization at the beginning of simulation */
 	if (clock_cycles == 0){
-		// <set PC register to instr_base_address>
+		// instr_base_address, or the PC reached by "run_functional" if the program has been fast-forwarded
+		sp_registers[IF][0][PC] = get_functional_pc();
 	}
 
 	/* ====== MAIN SIMULATION LOOP (one iteration per clock cycle)  ========= */
 	while(cycles==0 || clock_cycles-start_cycles!=cycles){
 
+		bool memory_stall = false; //the stages before MEM wait for a data memory access
+		bool data_stall = false; //an instruction in ID waits for an operand (RAW hazard)
+		unsigned memory_done_cycle = 0; //clock cycle at which all the data memory accesses of the group in MEM complete (UNDEFINED if one has not been issued)
+
                 /* =============== */
                 /* PIPELINE STAGES */
                 /* =============== */
 
 		/* ============   WB stage   ============  */
 
-			// <hint: the simulation loop should be exited when the instruction processed is EOP>
-	
+		if (ir[WB-1][0].opcode == EOP) break;
+		for (unsigned w=0; w<issue_width; w++){
+			const instruction_t &wb_instr = ir[WB-1][w];
+			unsigned *mem_wb = sp_registers[WB][w];
+			if (wb_instr.dest != UNDEFINED_REGISTER) gp_registers[wb_instr.dest] = (wb_instr.flags & CLASS_LOAD) ? mem_wb[LMD] : mem_wb[ALU_OUTPUT];
+			if (wb_instr.opcode != NOP) instructions_executed++;
+		}
+
 		/* ============   MEM stage   ===========  */
 
+		// the data memory accesses are issued in the first clock cycle the group spends in MEM (or retried, if they could not be issued),
+		// and the pipeline stalls until they all complete
+		for (unsigned w=0; w<issue_width; w++){
+			const instruction_t &mem_instr = ir[MEM-1][w];
+			if (!(mem_instr.flags & CLASS_MEMORY)) continue;
+			if (memory_ready_cycle[w] == UNDEFINED)
+				memory_ready_cycle[w] = data_memory_issue(sp_registers[MEM][w][ALU_OUTPUT], mem_instr.flags & CLASS_STORE, ir_pc[MEM-1][w]);
+			if (memory_ready_cycle[w] == UNDEFINED || clock_cycles < memory_ready_cycle[w]) memory_stall = true;
+			memory_done_cycle = (memory_ready_cycle[w] == UNDEFINED || memory_done_cycle == UNDEFINED) ? UNDEFINED : max(memory_done_cycle, memory_ready_cycle[w]);
+		}
+		if (memory_stall) stalls++;
+		for (unsigned w=0; w<issue_width; w++){
+			const instruction_t &mem_instr = ir[MEM-1][w];
+			unsigned *ex_mem = sp_registers[MEM][w], *mem_wb = sp_registers[WB][w];
+			clear_sp_registers(mem_wb);
+			if (memory_stall){
+				ir[WB-1][w] = nop_instruction;
+				ir_pc[WB-1][w] = UNDEFINED;
+			} else {
+				ir[WB-1][w] = mem_instr;
+				ir_pc[WB-1][w] = ir_pc[MEM-1][w];
+				mem_wb[ALU_OUTPUT] = ex_mem[ALU_OUTPUT];
+				if (mem_instr.flags & CLASS_LOAD) mem_wb[LMD] = read_memory(ex_mem[ALU_OUTPUT]);
+				// with forwarding, the data of a store is read when it is used (MEM/WB -> MEM): WB has just written the register file
+				if (mem_instr.flags & CLASS_STORE) write_memory(ex_mem[ALU_OUTPUT], forwarding.is_enabled() ? gp_registers[mem_instr.src2] : ex_mem[B]);
+				// without a branch predictor, branches are resolved here: the IF stage (processed next) fetches from the target of a taken branch
+				if (!predictor.is_enabled() && (mem_instr.flags & CLASS_BRANCH) && ex_mem[COND]) sp_registers[IF][0][PC] = ex_mem[ALU_OUTPUT];
+				memory_ready_cycle[w] = UNDEFINED;
+			}
+		}
+
 		/* ============   EXE stage   ===========  */
 
-			// <suggestion: use "alu" and "taken_branch" helper functions above to update ALU_OUTPUT and COND registers>
+		if (!memory_stall){
+			for (unsigned w=0; w<issue_width; w++){
+				const instruction_t &ex_instr = ir[EXE-1][w];
+				unsigned *id_ex = sp_registers[EXE][w], *ex_mem = sp_registers[MEM][w];
+				ir[MEM-1][w] = ex_instr;
+				ir_pc[MEM-1][w] = ir_pc[EXE-1][w];
+				clear_sp_registers(ex_mem);
+				if (ex_instr.opcode == NOP || ex_instr.opcode == EOP) continue;
+				unsigned a = id_ex[A], b = id_ex[B];
+				if (forwarding.is_enabled()){
+					a = forwarded_operand(ex_instr.src1, a);
+					if (!(ex_instr.flags & CLASS_STORE)) b = forwarded_operand(ex_instr.src2, b);
+				}
+				ex_mem[B] = b;
+				ex_mem[ALU_OUTPUT] = alu(ex_instr.opcode, a, b, id_ex[IMM], id_ex[NPC]);
+				if (ex_instr.flags & CLASS_BRANCH) ex_mem[COND] = taken_branch(ex_instr.opcode, a);
+				// with a branch predictor, branches are resolved here: on a misprediction, the group fetched after the branch (in IF/ID)
+				// is squashed, and the IF stage (processed next) fetches from the correct PC
+				// (a branch is the last instruction of its group, so that no younger instruction is in EXE)
+				if (predictor.is_enabled() && (ex_instr.flags & CLASS_BRANCH) &&
+				    resolve_branch(ir_pc[EXE-1][w], ex_mem[COND], ex_mem[ALU_OUTPUT], predicted_pc[EXE-1][w], EXE)){
+					sp_registers[IF][0][PC] = ex_mem[COND] ? ex_mem[ALU_OUTPUT] : id_ex[NPC];
+					for (unsigned v=0; v<issue_width; v++){
+						clear_sp_registers(sp_registers[ID][v]);
+						ir_pc[ID-1][v] = UNDEFINED;
+					}
+					stalls++;
+				}
+			}
+		}
 
 		/* ============   ID stage   ============  */
 
-			// <suggestion: use the helper functions "is_branch", "is_int_r", ..., above to improve code readability/compactness>
+		if (!memory_stall){
+			// RAW hazards with the older instructions in EXE and MEM (the ones in WB have already written the register file):
+			// each operand comes from the youngest of them writing its register, through the forwarding network if it can
+			// (the instructions of a group do not depend on each other, see fetch_group)
+			forwarding_path_t paths[MAX_ISSUE_WIDTH][2];
+			unsigned producer_stages[MAX_ISSUE_WIDTH][2];
+			for (unsigned w=0; w<issue_width; w++){
+				const instruction_t &id_instr = ir[ID-1][w];
+				const unsigned sources[2] = {id_instr.src1, id_instr.src2};
+				for (unsigned o=0; o<2; o++){
+					paths[w][o] = PATH_REGISTER_FILE;
+					producer_stages[w][o] = WB;
+					if (sources[o] == UNDEFINED_REGISTER) continue;
+					bool found = false;
+					for (unsigned s=MEM; s<=WB && !found; s++){
+						// the younger instructions of a group are in the higher slots
+						for (unsigned p=issue_width; p-- > 0 && !found; ){
+							const instruction_t &producer = ir[s-1][p];
+							if (producer.dest != sources[o]) continue;
+							found = true;
+							producer_stages[w][o] = s-1;
+							paths[w][o] = forwarding.path(s-1, (producer.flags & CLASS_LOAD) ? MEM : EXE, (o == 1 && (id_instr.flags & CLASS_STORE)) ? MEM : EXE);
+						}
+					}
+					if (paths[w][o] == PATH_STALL) data_stall = true;
+				}
+			}
+			if (data_stall) stalls++;
+			for (unsigned w=0; w<issue_width; w++){
+				const instruction_t &id_instr = ir[ID-1][w];
+				unsigned *if_id = sp_registers[ID][w], *id_ex = sp_registers[EXE][w];
+				clear_sp_registers(id_ex);
+				if (data_stall){
+					ir[EXE-1][w] = nop_instruction;
+					ir_pc[EXE-1][w] = UNDEFINED;
+				} else {
+					ir[EXE-1][w] = id_instr;
+					ir_pc[EXE-1][w] = ir_pc[ID-1][w];
+					predicted_pc[EXE-1][w] = predicted_pc[ID-1][w];
+					forwarding.count(paths[w], producer_stages[w]);
+					id_ex[NPC] = if_id[NPC];
+					if (id_instr.src1 != UNDEFINED_REGISTER) id_ex[A] = gp_registers[id_instr.src1];
+					if (id_instr.src2 != UNDEFINED_REGISTER) id_ex[B] = gp_registers[id_instr.src2];
+					id_ex[IMM] = id_instr.immediate;
+				}
+			}
+		}
 
 		/* ============   IF stage   ============  */
 
-			// <hint: when accessing the instruction memory, you will need to scale PC to an integer index as in the following pseudocode:>
-			// ir[IF/ID] = instr_memory[(PC-instr_base_address)>>2] 
+		if (!memory_stall && !data_stall){
+			unsigned &pc = sp_registers[IF][0][PC];
+			bool branch_in_flight = false;
+			for (unsigned w=0; w<issue_width; w++){
+				clear_sp_registers(sp_registers[ID][w]);
+				if ((ir[EXE-1][w].flags & CLASS_BRANCH) || (ir[MEM-1][w].flags & CLASS_BRANCH)) branch_in_flight = true;
+			}
+			if (!predictor.is_enabled() && branch_in_flight){
+				// a branch is in EXE or has just left ID: without a branch predictor, the fetch waits until it is resolved
+				stalls++;
+				for (unsigned w=0; w<issue_width; w++){
+					ir[ID-1][w] = nop_instruction;
+					ir_pc[ID-1][w] = UNDEFINED;
+				}
+			} else {
+				instruction_t group[MAX_ISSUE_WIDTH];
+				unsigned next_pc;
+				unsigned size = fetch_group(pc, group, next_pc);
+				// the instructions of a group are consecutive, and only the last one can be a branch:
+				// the fetch continues from its predicted target (pc+4 without a branch predictor)
+				for (unsigned w=0; w<issue_width; w++){
+					unsigned instr_pc = pc + 4*w;
+					ir[ID-1][w] = (w < size) ? group[w] : nop_instruction;
+					ir_pc[ID-1][w] = (w < size) ? instr_pc : UNDEFINED;
+					if (w >= size) continue;
+					sp_registers[ID][w][NPC] = (group[w].opcode != EOP) ? instr_pc + 4 : instr_pc;
+					predicted_pc[ID-1][w] = (w == size-1) ? next_pc : instr_pc + 4;
+				}
+				pc = next_pc;
+			}
+		}
 
                 /* =============== */
                 /* END STAGES      */
@@ -392,5 +776,9 @@ void sim_pipe::run(unsigned cycles){
                 /* ====================== */
 
 		clock_cycles++; // increase clock cycles count
+
+		// the pipeline is stalled on data memory accesses: the clock cycles until they all complete are all the same stall
+		if (cycle_skipping && memory_stall && memory_done_cycle != UNDEFINED && memory_done_cycle > clock_cycles)
+			skip_idle_cycles(memory_done_cycle - clock_cycles, cycles, start_cycles);
 	}
 }
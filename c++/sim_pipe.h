@@ -6,21 +6,26 @@ Email: tutorcs@163.com
 
 #include <stdio.h>
 #include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include "paged_memory.h"
+#include "memory_hierarchy.h"
+#include "forwarding.h"
+#include "program.h"
+#include "branch_predictor.h"
 
 using namespace std;
 
-#define PROGRAM_SIZE 50
 
-#define UNDEFINED 0xFFFFFFFF //used to initialize the registers
 #define NUM_SP_REGISTERS 9
 #define NUM_GP_REGISTERS 32
 #define NUM_OPCODES 16 
 #define NUM_STAGES 5
+#define MAX_ISSUE_WIDTH 4 //maximum number of instructions per pipeline stage (see init_superscalar)
 
 typedef enum {PC, NPC, IR, A, B, IMM, COND, ALU_OUTPUT, LMD} sp_register_t;
 
-typedef enum {LW, SW, ADD, ADDI, SUB, SUBI, XOR, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, NOP} opcode_t;
-
 typedef enum {IF, ID, EXE, MEM, WB} stage_t;
 
 /*
@@ -30,27 +35,41 @@ ADDI <dest> <src1> <immediate>
 LW <dest> <immediate>(<src1>)
 SW <src2> <immediate>(<src1>)
 BRANCH <src1> <immediate>
+
+Instructions are pre-decoded by load_program into a compact, trivially-copyable form,
+so that fetching and advancing them through the pipeline latches is a plain copy.
+Branch labels are resolved at load time and kept in a separate symbol table.
+
+Region of interest (ROI): the directives ".roi_begin" and ".roi_end", each on a line of its own (optionally
+after a label), mark the beginning and the end of the region of the program to be simulated in detail (see run_roi).
 */
-typedef struct{
-        opcode_t opcode; //opcode
-        unsigned src1; //source register #1 - see instruction encoding above 
-        unsigned src2; //source register #2 - see instruction encoding above
-        unsigned dest; //destination register
-        unsigned immediate; //immediate field
-        string label; //for conditional branches, label of the target instruction - used only for parsing/debugging purposes
-} instruction_t;
+
+/*
+Superscalar mode (see init_superscalar): the pipeline processes groups of up to "issue_width" instructions per stage,
+and each pipeline register holds one instruction per slot (slot 0 only in scalar mode). Groups are formed at fetch
+(see fetch_group), so that the instructions of a group can proceed together: a group ends
+- after a branch (the next group starts at its predicted target)
+- before an instruction depending (RAW or WAW) on an older instruction of the group
+- before an instruction which would exceed the ALUs or the data memory ports of the pipeline
+*/
+typedef enum {SPLIT_DEPENDENCY, SPLIT_ALU, SPLIT_MEMORY_PORT, SPLIT_BRANCH} group_split_t;
+
+#define NUM_GROUP_SPLITS 4
 
 
 class sim_pipe{
 
-        //instruction memory 
-        instruction_t instr_memory[PROGRAM_SIZE];
+        //program in instruction memory - read-only, possibly shared with other simulator instances
+        shared_ptr<const program_t> program;
+
+        //instruction memory (instructions of the program, indexed by (PC-instr_base_address)>>2)
+        const instruction_t *instr_memory;
+        unsigned instr_memory_size;
 
         //base address in the instruction memory where the program is loaded
         unsigned instr_base_address;
-
-	//data memory - should be initialize to all 0xFF
-	unsigned char *data_memory;
+	//data memory - sparse: pages are allocated on first write, locations never written read as 0xFF
+	paged_memory data_memory;
 
 	//memory size in bytes
 	unsigned data_memory_size;
@@ -58,17 +77,55 @@ class sim_pipe{
 	//memory latency in clock cycles
 	unsigned data_memory_latency;
 
+	//data caches and DRAM (timing only) - by default, every data memory access takes data_memory_latency clock cycles
+	memory_hierarchy data_memory_hierarchy;
+
+	//functional execution (see run_functional)
+	unsigned functional_pc; //PC of the next instruction to be executed functionally, or by run() when it starts
+	unsigned functional_instructions; //number of instructions executed functionally
+	unsigned roi_end_pc; //end of the region of interest while it is simulated in detail (UNDEFINED otherwise) - see run_roi
+	bool roi_end_fetched; //the last EOP fetched is the one at roi_end_pc, i.e., run() has stopped at the end of the region of interest
+
+	//idle clock cycles simulated at once (see init_cycle_skipping)
+	bool cycle_skipping;
+	unsigned skipped_cycles;
+
+	//forwarding network and its statistics (see init_forwarding)
+	forwarding_network forwarding;
+
+	//branch predictor (see init_branch_predictor), and clock cycles lost to mispredicted branches
+	branch_predictor predictor;
+	unsigned mispredict_penalty;
+
+	//superscalar mode (see init_superscalar), and fetch groups ended early for each reason
+	unsigned issue_width;
+	unsigned num_alus;
+	unsigned memory_ports;
+	unsigned group_splits[NUM_GROUP_SPLITS];
+
 	//statistics
 	unsigned clock_cycles;
 	unsigned stalls;
 	unsigned instructions_executed;
 
 	/* registers */
-        // <TODO: add general purpose registers here>
-        // <TODO: add pipeline registers (other than IR) here>
+	unsigned gp_registers[NUM_GP_REGISTERS]; //general purpose registers (UNDEFINED until written)
+
+	// pipeline registers: sp_registers[s][w] holds the special purpose registers of slot w at the entrance of stage s
+	// (PC in sp_registers[IF][0]; UNDEFINED if not used by the instruction in that slot)
+	unsigned sp_registers[NUM_STAGES][MAX_ISSUE_WIDTH][NUM_SP_REGISTERS];
+
+	// IR is stored using the instruction_t data type (one per slot, see init_superscalar)
+	instruction_t ir[NUM_STAGES-1][MAX_ISSUE_WIDTH];
+
+	// address of the instruction in each IR (UNDEFINED for bubbles) - not a special purpose register, used by the prefetcher and the branch predictor
+	unsigned ir_pc[NUM_STAGES-1][MAX_ISSUE_WIDTH];
+
+	// PC from which the fetch continued after the instruction in each IR, as predicted in IF (see predict_next_pc)
+	unsigned predicted_pc[NUM_STAGES-1][MAX_ISSUE_WIDTH];
 
-	// IR is stored using the instruction_t data type
-	instruction_t ir[NUM_STAGES-1];
+	// clock cycle at which the data memory access of the instruction in each slot of MEM completes (UNDEFINED until it has been issued)
+	unsigned memory_ready_cycle[MAX_ISSUE_WIDTH];
 
 public:
 
@@ -81,8 +138,44 @@ public:
 	//loads the assembly program in file "filename" in instruction memory at the specified address
 	void load_program(const char *filename, unsigned base_address=0x0);
 
+	//loads the binary program image in file "filename" (see save_binary) in instruction memory at the specified address
+	void load_binary(const char *filename, unsigned base_address=0x0);
+
+	//saves the program currently in instruction memory as a binary program image in file "filename"
+	void save_binary(const char *filename);
+
+	//parses the assembly program in file "filename" - the program returned can be attached to any number of simulator instances
+	static shared_ptr<const program_t> read_program(const char *filename);
+
+	//reads the binary program image in file "filename" - the program returned can be attached to any number of simulator instances
+	static shared_ptr<const program_t> read_binary(const char *filename);
+
+	//attaches an already loaded program to instruction memory at the specified address (the program is shared, not copied)
+	void attach_program(shared_ptr<const program_t> program, unsigned base_address=0x0);
+
+	//returns the program currently in instruction memory (NULL if no program is loaded)
+	shared_ptr<const program_t> get_program();
+
 	//runs the simulator for "cycles" clock cycles (run the program to completion if cycles=0) 
 	void run(unsigned cycles=0);
+
+	//executes "instructions" instructions functionally (up to EOP if instructions=0): architecturally, without modeling the pipeline
+	//- the execution starts from the beginning of the program, or where the previous functional execution stopped, and stops before EOP
+	//- registers are accessed through get_gp_register/set_gp_register, data memory through read_memory/write_memory
+	//- clock cycles and statistics are not updated: run() then simulates the rest of the program in detail, starting from get_functional_pc()
+	//returns the number of instructions executed
+	unsigned run_functional(unsigned instructions=0);
+
+	//runs the program, simulating in detail only its region of interest (marked by the .roi_begin and .roi_end directives):
+	//- the program is executed functionally up to .roi_begin (see run_functional)
+	//- the region is simulated in detail with run(), to which .roi_end looks like the end of the program (EOP)
+	//- the rest of the program is executed functionally
+	//as a result, the statistics (clock cycles, stalls, instructions executed, IPC) only cover the region of interest
+	//a missing .roi_begin (.roi_end) directive stands for the beginning (end) of the program
+	void run_roi();
+
+	//returns the PC of the next instruction to be executed after run_functional (the beginning of the program if run_functional has not been invoked)
+	unsigned get_functional_pc();
 	
 	//resets the state of the simulator
         /* Note: 
@@ -116,21 +209,169 @@ public:
 	//returns the number of instructions fully executed
 	unsigned get_instructions_executed();
 
+	//returns the number of instructions executed functionally (see run_functional)
+	unsigned get_functional_instructions();
+
 	//returns the number of clock cycles 
 	unsigned get_clock_cycles();
 
 	//returns the number of stalls added by processor
 	unsigned get_stalls();
 
+	//returns the number of clock cycles (included in get_clock_cycles) which have been skipped as idle (see init_cycle_skipping)
+	unsigned get_skipped_cycles();
+
+	//returns the number of hits, misses and evictions in the given data cache level
+	unsigned get_cache_hits(cache_level_t level);
+	unsigned get_cache_misses(cache_level_t level);
+	unsigned get_cache_evictions(cache_level_t level);
+
+	//returns the memory-level parallelism (average number of outstanding L1 misses, when at least one is outstanding)
+	float get_memory_level_parallelism();
+
+	//returns the number of L1 misses merged into an outstanding miss to the same line
+	unsigned get_merged_misses();
+
+	//returns the number of data memory accesses which could not be issued because all the MSHRs were busy
+	unsigned get_mshr_full_stalls();
+
+	//returns the number of DRAM row hits, row misses (bank without an open row) and row conflicts (another row open)
+	unsigned get_dram_row_hits();
+	unsigned get_dram_row_misses();
+	unsigned get_dram_row_conflicts();
+
+	//returns the accuracy (useful/issued prefetches), coverage (fraction of L1 misses removed) and timeliness (fraction of useful prefetches not late) of the prefetcher
+	float get_prefetch_accuracy();
+	float get_prefetch_coverage();
+	float get_prefetch_timeliness();
+
+	//returns the number of loads forwarded from the store buffer, and the number of stores stalled because the store buffer was full
+	unsigned get_forwarded_loads();
+	unsigned get_store_buffer_full_stalls();
+
+	//returns the number of operands forwarded through the given path, and the number of RAW stalls that path removed (see init_forwarding)
+	unsigned get_forwarded_operands(forwarding_path_t path);
+	unsigned get_forwarding_saved_stalls(forwarding_path_t path);
+
+	//returns the accuracy of the branch predictor (fraction of the branches correctly predicted - 0 if no branch has been resolved),
+	//the number of mispredicted branches, the number of clock cycles lost to them, and the number of taken branches missing in the BTB
+	float get_branch_prediction_accuracy();
+	unsigned get_branch_mispredictions();
+	unsigned get_branch_mispredict_penalty();
+	unsigned get_btb_misses();
+
+	//returns the number of fetch groups ended early (with fewer than issue_width instructions) for the given reason
+	unsigned get_group_splits(group_split_t reason);
+
 	//prints the content of the data memory within the specified address range
 	void print_memory(unsigned start_address, unsigned end_address);
 
 	// writes an integer value to data memory at the specified address (use little-endian format: https://en.wikipedia.org/wiki/Endianness)
 	void write_memory(unsigned address, unsigned value);
 
+	// reads an integer value from data memory at the specified address (little-endian format)
+	unsigned read_memory(unsigned address);
+
+	// writes "size" bytes from "data" to data memory, starting at the specified address
+	void write_memory_block(unsigned address, const unsigned char *data, unsigned size);
+
+	// loads the memory image in file "filename" (raw binary or sectioned image, see paged_memory.h) in data memory at the specified address
+	void load_memory_image(const char *filename, unsigned base_address=0x0);
+
+	// adds a data cache level in front of data memory
+	// - level: CACHE_L1 or CACHE_L2 (an L2 cache requires an L1 cache)
+	// - size, line_size: in bytes (powers of 2)
+	// - associativity: number of ways (size/line_size for a fully associative cache)
+	// - hit_latency: in clock cycles
+	void init_cache(cache_level_t level, unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency, replacement_policy_t replacement=REPL_LRU, write_policy_t write_policy=WRITE_BACK);
+
+	// makes the L1 data cache non-blocking, with "num_mshrs" miss status holding registers (0: blocking cache, the default)
+	// independent misses can then overlap their latency (see data_memory_issue) - the pipeline itself stalls in MEM until each
+	// access completes, so that it never has more than one miss outstanding
+	void init_mshrs(unsigned num_mshrs);
+
+	// replaces the fixed data memory latency with a DRAM model (see dram.h)
+	// - num_banks: number of banks (power of 2)
+	// - row_size: size of a row in bytes (power of 2)
+	// - row_hit_latency, row_miss_latency, row_conflict_latency: in clock cycles
+	void init_dram(unsigned num_banks, unsigned row_size, unsigned row_hit_latency, unsigned row_miss_latency, unsigned row_conflict_latency);
+
+	// adds a stride prefetcher (with next-line fallback) to the L1 data cache (see prefetcher.h)
+	// - table_size: number of entries of the stride table, indexed by the PC of the loads (power of 2)
+	// - degree: number of lines prefetched at each trigger
+	// prefetchers are trained by the loads issued through data_memory_issue
+	void init_prefetcher(unsigned table_size, unsigned degree=1);
+
+	// adds a store buffer with "num_entries" entries in front of the data caches (see memory_hierarchy.h)
+	// stores issued through data_memory_issue then complete without waiting for the memory latency,
+	// and loads to the address of a buffered store get its value forwarded
+	void init_store_buffer(unsigned num_entries);
+
+	// sets the forwarding network (NO_FORWARDING by default - see forwarding.h)
+	// the configuration is preserved by reset()
+	void init_forwarding(forwarding_t forwarding);
+
+	// enables (the default) or disables the skipping of idle clock cycles: while the pipeline is stalled on a data memory access,
+	// the clock cycles until the access completes are simulated at once - the statistics are the same either way
+	// the configuration is preserved by reset()
+	void init_cycle_skipping(bool enabled);
+
+	// adds a dynamic branch predictor to the IF stage (see branch_predictor.h)
+	// - type: PREDICT_NOT_TAKEN, PREDICT_BIMODAL or PREDICT_GSHARE
+	// - table_size: number of 2-bit counters (power of 2 - not used by PREDICT_NOT_TAKEN)
+	// - history_bits: length of the global history (PREDICT_GSHARE only)
+	// - btb_size: number of entries of the branch target buffer (power of 2 - 0: no BTB, targets known at fetch)
+	// without a predictor, the pipeline stalls on every branch until it is resolved (in MEM); with a predictor, the fetch continues
+	// from the predicted PC, branches are resolved in EXE, and a mispredicted branch squashes the instruction fetched after it
+	void init_branch_predictor(predictor_t type, unsigned table_size=0, unsigned history_bits=0, unsigned btb_size=0);
+
+	// makes the pipeline superscalar (see group_split_t), processing up to "issue_width" instructions per stage
+	// - num_alus: number of ALUs of the EXE stage (0: one per slot)
+	// - memory_ports: number of data memory accesses per clock cycle
+	// exits with an error if the configuration is not valid, or if the simulation has already started
+	void init_superscalar(unsigned issue_width, unsigned num_alus=0, unsigned memory_ports=1);
+
 	//prints the values of the registers 
 	void print_registers();
 
+private:
+
+	// returns the instruction stored at address "pc" in instruction memory (a NOP if "pc" is outside the loaded program)
+	// (EOP at the end of the region of interest, while it is simulated in detail by run_roi)
+	const instruction_t &fetch_instruction(unsigned pc);
+
+	// returns the number of clock cycles taken by a data memory access to the specified address (through the data caches, if any)
+	unsigned data_memory_access_latency(unsigned address, bool is_write);
+
+	// issues a data memory access to the specified address in the current clock cycle, by the instruction at "pc" (non-blocking caches, see init_mshrs)
+	// returns the clock cycle at which the access completes, or UNDEFINED if all the MSHRs are busy or the store buffer is full (the access has to be retried)
+	unsigned data_memory_issue(unsigned address, bool is_write, unsigned pc=UNDEFINED);
+
+	// returns the value of register "reg" for the instruction entering EXE with forwarding enabled ("value", read in ID, if reg is UNDEFINED_REGISTER)
+	// - to be invoked in the EXE stage, once MEM and WB have been processed
+	unsigned forwarded_operand(unsigned reg, unsigned value);
+
+	// returns the PC from which to fetch after "instruction", fetched at "pc" (pc+4, unless a branch predicted taken by the branch predictor)
+	unsigned predict_next_pc(unsigned pc, const instruction_t &instruction);
+
+	// updates the branch predictor with the branch at "pc", resolved in stage "stage" (taken or not, towards "target"), which had been predicted to continue at "predicted_pc"
+	// on a misprediction, squashes the younger instructions (replacing them with NOPs in the pipeline registers ir[IF] ... ir[stage-2], all slots),
+	// adds the clock cycles lost to the mispredict penalty, and returns true: the fetch has then to be redirected to the correct PC
+	bool resolve_branch(unsigned pc, bool taken, unsigned target, unsigned predicted_pc, stage_t stage);
+
+	// fetches the group of instructions starting at "pc" (see group_split_t) into "group" (MAX_ISSUE_WIDTH entries), and returns its size
+	// next_pc is set to the PC from which to fetch the next group (see predict_next_pc)
+	// - to be invoked once per fetched group (the statistics of the group splits are updated)
+	unsigned fetch_group(unsigned pc, instruction_t *group, unsigned &next_pc);
+
+	// skips "n" idle clock cycles, i.e., clock cycles in which the pipeline is stalled and nothing changes but the cycle count:
+	// clock cycles and stalls are increased by n
+	// n is capped to the clock cycles left in the current run(cycles) invocation (given its "cycles" and "start_cycles"), so that the run budget is respected
+	void skip_idle_cycles(unsigned n, unsigned cycles, unsigned start_cycles);
+
+	// executes instructions functionally (see run_functional), stopping after "instructions" instructions (if not 0), before EOP, or before "stop_pc"
+	unsigned execute_functional(unsigned instructions, unsigned stop_pc);
+
 };
 
 #endif /*SIM_PIPE_H_*/
@@ -4,11 +4,13 @@ Email: tutorcs@163.com
 #include "sim_pipe_fp.h"
 #include <stdlib.h>
 #include <iostream>
-#include <fstream>
 #include <cstring>
 #include <string>
 #include <iomanip>
 #include <map>
+#include <vector>
+#include <memory>
+#include <algorithm>
 
 //NOTE: structural hazards on MEM/WB stage not handled
 //====================================================
@@ -24,6 +26,12 @@ static const char *stage_names[NUM_STAGES] = {"IF", "ID", "EX", "MEM", "WB"};
 static const char *instr_names[NUM_OPCODES] = {"LW", "SW", "ADD", "ADDI", "SUB", "SUBI", "XOR", "BEQZ", "BNEZ", "BLTZ", "BGTZ", "BLEZ", "BGEZ", "JUMP", "EOP", "NOP", "LWS", "SWS", "ADDS", "SUBS", "MULTS", "DIVS"};
 static const char *unit_names[4]={"INTEGER", "ADDER", "MULTIPLIER", "DIVIDER"};
 
+//empty instruction slot
+static const instruction_t nop_instruction = {NOP, 0, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED, UNDEFINED};
+
+//end of the program (returned by fetch_instruction at the end of the region of interest)
+static const instruction_t eop_instruction = {EOP, 0, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED_REGISTER, UNDEFINED, UNDEFINED};
+
 /* =============================================================
 
    HELPER FUNCTIONS
@@ -57,32 +65,6 @@ inline unsigned char2unsigned(unsigned char *buffer){
        return buffer[0] + (buffer[1] << 8) + (buffer[2] << 16) + (buffer[3] << 24);
 }
 
-/* the following functions return the kind of the considered opcode */
-
-bool is_branch(opcode_t opcode){
-	return (opcode == BEQZ || opcode == BNEZ || opcode == BLTZ || opcode == BLEZ || opcode == BGTZ || opcode == BGEZ || opcode == JUMP);
-}
-
-bool is_memory(opcode_t opcode){
-        return (opcode == LW || opcode == SW || opcode == LWS || opcode == SWS);
-}
-
-bool is_int_r(opcode_t opcode){
-        return (opcode == ADD || opcode == SUB || opcode == XOR);
-}
-
-bool is_int_imm(opcode_t opcode){
-        return (opcode == ADDI || opcode == SUBI);
-}
-
-bool is_int_alu(opcode_t opcode){
-        return (is_int_r(opcode) || is_int_imm(opcode));
-}
-
-bool is_fp_alu(opcode_t opcode){
-        return (opcode == ADDS || opcode == SUBS || opcode == MULTS || opcode == DIVS);
-}
-
 /* implements the ALU operations */
 unsigned alu(unsigned opcode, unsigned a, unsigned b, unsigned imm, unsigned npc){
 	switch(opcode){
@@ -166,13 +148,28 @@ bool taken_branch(opcode_t opcode, unsigned a){
 sim_pipe_fp::sim_pipe_fp(unsigned mem_size, unsigned mem_latency){
 	data_memory_size = mem_size;
 	data_memory_latency = mem_latency;
-	data_memory = new unsigned char[data_memory_size];
-	num_units = 0;
+	data_memory_hierarchy.set_memory_latency(mem_latency);
+	cycle_skipping = true;
+	scoreboarding = false;
+	tomasulo = false;
+	cdb_width = 1;
+	commit_width = 1;
+	for (unsigned t=0; t<=NUM_UNIT_TYPES; t++) station_begin[t] = 0;
+	for (unsigned t=0; t<=NUM_UNIT_TYPES; t++) unit_begin[t] = 0;
 	reset();
 }
 	
 sim_pipe_fp::~sim_pipe_fp(){
-	delete [] data_memory;
+}
+
+/* ============== primitives to save/restore the state of the simulator ================== */
+
+sim_pipe_fp_checkpoint *sim_pipe_fp::save_checkpoint(){
+	return new sim_pipe_fp_checkpoint(*this);
+}
+
+void sim_pipe_fp::restore_checkpoint(const sim_pipe_fp_checkpoint *checkpoint){
+	*this = checkpoint->state;
 }
 
 /* =============   primitives to print out the content of the memory & registers and for writing to memory ============== */ 
@@ -181,10 +178,10 @@ void sim_pipe_fp::print_memory(unsigned start_address, unsigned end_address){
 	cout << "data_memory[0x" << hex << setw(8) << setfill('0') << start_address << ":0x" << hex << setw(8) << setfill('0') <<  end_address << "]" << endl;
 	for (unsigned i=start_address; i<end_address; i++){
 		if (i%4 == 0) cout << "0x" << hex << setw(8) << setfill('0') << i << ": "; 
-		cout << hex << setw(2) << setfill('0') << int(data_memory[i]) << " ";
+		cout << hex << setw(2) << setfill('0') << int(data_memory.read_byte(i)) << " ";
 		if (i%4 == 3){
 #ifdef DEBUG_MEMORY 
-			unsigned u = char2unsigned(&data_memory[i-3]);
+			unsigned u = data_memory.read_word(i-3);
 			cout << " - unsigned=" << u << " - float=" << unsigned2float(u);
 #endif
 			cout << endl;
@@ -193,7 +190,88 @@ void sim_pipe_fp::print_memory(unsigned start_address, unsigned end_address){
 }
 
 void sim_pipe_fp::write_memory(unsigned address, unsigned value){
-	unsigned2char(value,data_memory+address);
+	data_memory.write_word(address, value);
+}
+
+unsigned sim_pipe_fp::read_memory(unsigned address){
+	return data_memory.read_word(address);
+}
+
+void sim_pipe_fp::write_memory_block(unsigned address, const unsigned char *data, unsigned size){
+	data_memory.write_block(address, data, size);
+}
+
+void sim_pipe_fp::load_memory_image(const char *filename, unsigned base_address){
+	if (!data_memory.load_image(filename, base_address)){
+		cerr << "error: loading memory image " << filename << " failed!" << endl;
+		exit(-1);
+	}
+}
+
+void sim_pipe_fp::init_cache(cache_level_t level, unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency, replacement_policy_t replacement, write_policy_t write_policy){
+	data_memory_hierarchy.configure_cache(level, size, associativity, line_size, hit_latency, replacement, write_policy);
+}
+
+void sim_pipe_fp::init_mshrs(unsigned num_mshrs){
+	data_memory_hierarchy.configure_mshrs(num_mshrs);
+}
+
+void sim_pipe_fp::init_dram(unsigned num_banks, unsigned row_size, unsigned row_hit_latency, unsigned row_miss_latency, unsigned row_conflict_latency){
+	data_memory_hierarchy.configure_dram(num_banks, row_size, row_hit_latency, row_miss_latency, row_conflict_latency);
+}
+
+void sim_pipe_fp::init_prefetcher(unsigned table_size, unsigned degree){
+	data_memory_hierarchy.configure_prefetcher(table_size, degree);
+}
+
+void sim_pipe_fp::init_store_buffer(unsigned num_entries){
+	data_memory_hierarchy.configure_store_buffer(num_entries);
+}
+
+void sim_pipe_fp::init_forwarding(forwarding_t forwarding){
+	this->forwarding.configure(forwarding);
+}
+
+/* enables or disables the skipping of idle clock cycles */
+void sim_pipe_fp::init_cycle_skipping(bool enabled){
+	cycle_skipping = enabled;
+}
+
+void sim_pipe_fp::init_scoreboard(){
+	scoreboarding = true;
+}
+
+void sim_pipe_fp::init_tomasulo(unsigned rob_size, unsigned width, unsigned commits){
+	if (rob_size == 0 || width == 0 || commits == 0){
+		cerr << "error: invalid Tomasulo configuration (rob_size=" << rob_size << " cdb_width=" << width << " commit_width=" << commits << ")!" << endl;
+		exit(-1);
+	}
+	if (clock_cycles != 0){
+		cerr << "error: the Tomasulo engine cannot be configured once the simulation has started!" << endl;
+		exit(-1);
+	}
+	tomasulo = true;
+	cdb_width = width;
+	commit_width = commits;
+	rob.resize(rob_size);
+	tomasulo_flush();
+}
+
+void sim_pipe_fp::init_reservation_stations(exe_unit_t type, unsigned num_stations){
+	if ((unsigned)type >= NUM_UNIT_TYPES || num_stations == 0){
+		cerr << "error: invalid reservation station configuration (type=" << type << " stations=" << num_stations << ")!" << endl;
+		exit(-1);
+	}
+	if (clock_cycles != 0){
+		cerr << "error: reservation stations cannot be added once the simulation has started!" << endl;
+		exit(-1);
+	}
+	reservation_station_t station;
+	station.busy = false;
+	station.completion_cycle = UNDEFINED;
+	station.cdb_stalled = false;
+	stations.insert(stations.begin() + station_begin[type+1], num_stations, station);
+	for (unsigned t=type+1; t<=NUM_UNIT_TYPES; t++) station_begin[t] += num_stations;
 }
 
 
@@ -215,207 +293,387 @@ void sim_pipe_fp::print_registers(){
 
 /* =============   primitives related to the functional units ============== */ 
 
+/* execution unit used by each opcode (UNDEFINED for the operations not requiring an exec unit) */
+static const unsigned opcode_unit[NUM_OPCODES] = {
+	INTEGER, INTEGER, INTEGER, INTEGER, INTEGER, INTEGER, INTEGER, //LW, SW, ADD, ADDI, SUB, SUBI, XOR
+	INTEGER, INTEGER, INTEGER, INTEGER, INTEGER, INTEGER, INTEGER, //BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP
+	UNDEFINED, UNDEFINED, //EOP, NOP
+	INTEGER, INTEGER, //LWS, SWS
+	ADDER, ADDER, MULTIPLIER, DIVIDER //ADDS, SUBS, MULTS, DIVS
+};
+
 /* initializes an execution unit */ 
-void sim_pipe_fp::init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances){
-	for (unsigned i=0; i<instances; i++){
-		exec_units[num_units].type = exec_unit;
-		exec_units[num_units].latency = latency;
-		exec_units[num_units].busy = 0;
-		exec_units[num_units].instruction.opcode = NOP;
-		num_units++;
+void sim_pipe_fp::init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances, unsigned initiation_interval){
+	if ((unsigned)exec_unit >= NUM_UNIT_TYPES){
+		cout << "ERROR:: invalid execution unit type " << exec_unit << "!\n";
+		exit(-1);
+	}
+	if (instances == 0){
+		cout << "ERROR:: at least one " << unit_names[exec_unit] << " unit must be added!\n";
+		exit(-1);
+	}
+	if (initiation_interval > latency){
+		cout << "ERROR:: the initiation interval of a " << unit_names[exec_unit] << " unit cannot exceed its latency!\n";
+		exit(-1);
+	}
+	if (clock_cycles != 0){
+		cout << "ERROR:: execution units cannot be added once the simulation has started!\n";
+		exit(-1);
+	}
+	unit_t unit;
+	unit.type = exec_unit;
+	unit.latency = latency;
+	unit.initiation_interval = (initiation_interval == 0) ? latency : initiation_interval;
+	unit.ready_cycle = 0;
+	unit.instruction.opcode = NOP;
+	unit.completions.assign(latency == 0 ? 0 : (latency + unit.initiation_interval - 1) / unit.initiation_interval, 0);
+	unit.oldest_completion = 0;
+	unit.in_flight = 0;
+	// the new units are appended to the ones of the same type, shifting the units of the following types
+	exec_units.insert(exec_units.begin() + unit_begin[exec_unit+1], instances, unit);
+	for (unsigned t=exec_unit+1; t<=NUM_UNIT_TYPES; t++) unit_begin[t] += instances;
+	// all the units are free, so any order is a valid heap
+	unit_heap.resize(exec_units.size());
+	unit_heap_position.resize(exec_units.size());
+	for (unsigned u=0; u<exec_units.size(); u++){
+		unit_heap[u] = u;
+		unit_heap_position[u] = u;
+	}
+	scoreboard.resize(exec_units.size());
+	for (unsigned u=0; u<exec_units.size(); u++){
+		scoreboard[u].busy = false;
+		scoreboard[u].completion_cycle = UNDEFINED;
 	}
 }
 
 /* returns a free unit for that particular operation or UNDEFINED if no unit is currently available */
 unsigned sim_pipe_fp::get_free_unit(opcode_t opcode){
-	if (num_units == 0){
+	if (exec_units.empty()){
 		cout << "ERROR:: simulator does not have any execution units!\n";
 		exit(-1);
 	}
-	for (unsigned u=0; u<num_units; u++){
-		switch(opcode){
-			//Integer unit
-			case LW:
-			case SW:
-			case ADD:
-			case ADDI:
-			case SUB:
-			case SUBI:
-			case XOR:
-			case BEQZ:
-			case BNEZ:
-			case BLTZ:
-			case BGTZ:
-			case BLEZ:
-			case BGEZ:
-			case JUMP:
-			case LWS: 
-			case SWS:
-				if (exec_units[u].type==INTEGER && exec_units[u].busy==0) return u;
-				break;
-			// FP adder
-			case ADDS:
-			case SUBS:
-				if (exec_units[u].type==ADDER && exec_units[u].busy==0) return u;
-				break;
-			// Multiplier
-			case MULTS:
-				if (exec_units[u].type==MULTIPLIER && exec_units[u].busy==0) return u;
-				break;
-			// Divider
-			case DIVS:
-				if (exec_units[u].type==DIVIDER && exec_units[u].busy==0) return u;
-				break;
-			default:
-				cout << "ERROR:: operations not requiring exec unit!\n";
-				exit(-1);
-		}
+	unsigned type = opcode_unit[opcode];
+	if (type == UNDEFINED){
+		cout << "ERROR:: operations not requiring exec unit!\n";
+		exit(-1);
+	}
+	if (unit_begin[type] != unit_begin[type+1]){
+		unsigned u = unit_heap[unit_begin[type]];
+		if (exec_units[u].ready_cycle <= clock_cycles) return u;
+	}
+	if (last_structural_stall[type] != clock_cycles){
+		structural_stalls[type]++;
+		last_structural_stall[type] = clock_cycles;
 	}
 	return UNDEFINED;
 }
 
-/* decrease the amount of clock cycles during which the functional unit will be busy - to be called at each clock cycle  */
-void sim_pipe_fp::decrement_units_busy_time(){
-	for (unsigned u=0; u<num_units; u++){
-		if (exec_units[u].busy > 0) exec_units[u].busy --;
+/* starts executing an instruction on a unit, which stays busy for its initiation interval */
+unsigned sim_pipe_fp::start_unit(unsigned unit, const instruction_t &instruction){
+	unit_t &u = exec_units[unit];
+	u.instruction = instruction;
+	u.ready_cycle = clock_cycles + u.initiation_interval;
+	if (u.latency != 0){
+		retire_unit(unit);
+		u.completions[(u.oldest_completion + u.in_flight) % u.completions.size()] = clock_cycles + u.latency;
+		u.in_flight++;
+	}
+	sift_unit_down(unit);
+	return clock_cycles + u.latency;
+}
+
+/* removes from a unit the instructions in flight which have completed */
+void sim_pipe_fp::retire_unit(unsigned unit){
+	unit_t &u = exec_units[unit];
+	while (u.in_flight != 0 && u.completions[u.oldest_completion] <= clock_cycles){
+		u.oldest_completion = (u.oldest_completion + 1) % u.completions.size();
+		u.in_flight--;
+	}
+}
+
+/* returns the number of clock cycles during which a unit is still busy */
+unsigned sim_pipe_fp::unit_busy_time(unsigned unit){
+	return (exec_units[unit].ready_cycle > clock_cycles) ? exec_units[unit].ready_cycle - clock_cycles : 0;
+}
+
+/* moves a unit towards the leaves of the heap of its type, after its ready cycle has increased */
+void sim_pipe_fp::sift_unit_down(unsigned unit){
+	unsigned base = unit_begin[exec_units[unit].type];
+	unsigned *heap = &unit_heap[base];
+	unsigned size = unit_begin[exec_units[unit].type+1] - base;
+	unsigned pos = unit_heap_position[unit] - base;
+	while (2*pos+1 < size){
+		unsigned child = 2*pos+1;
+		if (child+1 < size && exec_units[heap[child+1]].ready_cycle < exec_units[heap[child]].ready_cycle) child++;
+		if (exec_units[heap[child]].ready_cycle >= exec_units[unit].ready_cycle) break;
+		heap[pos] = heap[child];
+		unit_heap_position[heap[pos]] = base + pos;
+		pos = child;
+	}
+	heap[pos] = unit;
+	unit_heap_position[unit] = base + pos;
+}
+
+/* moves a unit towards the root of the heap of its type, after its ready cycle has decreased */
+void sim_pipe_fp::sift_unit_up(unsigned unit){
+	unsigned base = unit_begin[exec_units[unit].type];
+	unsigned *heap = &unit_heap[base];
+	unsigned pos = unit_heap_position[unit] - base;
+	while (pos > 0){
+		unsigned parent = (pos-1)/2;
+		if (exec_units[heap[parent]].ready_cycle <= exec_units[unit].ready_cycle) break;
+		heap[pos] = heap[parent];
+		unit_heap_position[heap[pos]] = base + pos;
+		pos = parent;
 	}
+	heap[pos] = unit;
+	unit_heap_position[unit] = base + pos;
 }
 
+/* returns the number of upcoming clock cycles during which all the busy execution units stay busy */
+unsigned sim_pipe_fp::idle_unit_cycles(){
+	unsigned idle = UNDEFINED;
+	for (unsigned u=0; u<exec_units.size(); u++){
+		if (exec_units[u].ready_cycle > clock_cycles) idle = min(idle, exec_units[u].ready_cycle - clock_cycles - 1);
+		retire_unit(u);
+		if (exec_units[u].in_flight != 0) idle = min(idle, exec_units[u].completions[exec_units[u].oldest_completion] - clock_cycles - 1);
+		if (scoreboard[u].completion_cycle != UNDEFINED && scoreboard[u].completion_cycle > clock_cycles) idle = min(idle, scoreboard[u].completion_cycle - clock_cycles - 1);
+	}
+	return idle;
+}
+
+/* skips "n" idle clock cycles (at most the ones left in the current run(cycles) invocation) */
+void sim_pipe_fp::skip_idle_cycles(unsigned n, unsigned cycles, unsigned start_cycles){
+	if (cycles != 0) n = min(n, cycles - (clock_cycles - start_cycles));
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+		if (last_structural_stall[t] != clock_cycles - 1) continue;
+		structural_stalls[t] += n;
+		last_structural_stall[t] = clock_cycles - 1 + n;
+	}
+	clock_cycles += n;
+	stalls += n;
+	skipped_cycles += n;
+}
 
 /* prints out the status of the functional units */
 void sim_pipe_fp::debug_units(){
-	for (unsigned u=0; u<num_units; u++){
-		cout << " -- unit " << unit_names[exec_units[u].type] << " latency=" << exec_units[u].latency << " busy=" << exec_units[u].busy <<
+	for (unsigned u=0; u<exec_units.size(); u++){
+		cout << " -- unit " << unit_names[exec_units[u].type] << " latency=" << exec_units[u].latency << " II=" << exec_units[u].initiation_interval << " in_flight=" << exec_units[u].in_flight << " busy=" << unit_busy_time(u) <<
 			" instruction=" << instr_names[exec_units[u].instruction.opcode] << endl;
 	}
 }
 
+/* registers read and written by an instruction, in the numbering of the scoreboard (UNDEFINED if none) */
+static unsigned destination_register(const instruction_t &instruction){
+	if (instruction.dest == UNDEFINED_REGISTER) return UNDEFINED;
+	return (instruction.flags & CLASS_FP) ? NUM_GP_REGISTERS + instruction.dest : instruction.dest;
+}
+
+static unsigned source_register(const instruction_t &instruction, unsigned s){
+	unsigned reg = (s == 0) ? instruction.src1 : instruction.src2;
+	if (reg == UNDEFINED_REGISTER) return UNDEFINED;
+	bool fp = (s == 0) ? (instruction.flags & CLASS_FP_ALU) : (instruction.flags & CLASS_FP);
+	return fp ? NUM_GP_REGISTERS + reg : reg;
+}
+
+/* scoreboard issue stage: assigns the instruction to a free unit, if there are no structural and WAW hazards */
+bool sim_pipe_fp::scoreboard_issue(const instruction_t &instruction, unsigned pc, unsigned &unit){
+	unit = get_free_unit(instruction.opcode);
+	if (unit == UNDEFINED){
+		count_hazard_stall(STRUCTURAL_HAZARD);
+		return false;
+	}
+	unsigned dest = destination_register(instruction);
+	if (dest != UNDEFINED && register_producer[dest] != UNDEFINED){
+		count_hazard_stall(WAW_HAZARD);
+		unit = UNDEFINED;
+		return false;
+	}
+	scoreboard_entry_t &entry = scoreboard[unit];
+	entry.busy = true;
+	entry.dest = dest;
+	for (unsigned s=0; s<2; s++){
+		entry.src[s] = source_register(instruction, s);
+		entry.producer[s] = (entry.src[s] == UNDEFINED) ? UNDEFINED : register_producer[entry.src[s]];
+		entry.ready[s] = (entry.producer[s] == UNDEFINED);
+	}
+	entry.completion_cycle = UNDEFINED;
+	entry.pc = pc;
+	entry.issue_cycle = clock_cycles;
+	if (dest != UNDEFINED) register_producer[dest] = unit;
+	// the unit is held until the result is written
+	exec_units[unit].instruction = instruction;
+	exec_units[unit].ready_cycle = UNDEFINED;
+	sift_unit_down(unit);
+	return true;
+}
+
+/* scoreboard read operands stage: starts the execution once the source registers are available */
+bool sim_pipe_fp::scoreboard_read_operands(unsigned unit){
+	scoreboard_entry_t &entry = scoreboard[unit];
+	if (entry.completion_cycle != UNDEFINED) return true;
+	const instruction_t &instr = exec_units[unit].instruction;
+	bool raw_hazard = !entry.ready[0] || !entry.ready[1];
+	// loads read the data memory after the older stores have written it
+	for (unsigned f=0; f<scoreboard.size() && !raw_hazard && (instr.flags & CLASS_LOAD); f++)
+		if (scoreboard[f].busy && (exec_units[f].instruction.flags & CLASS_STORE) && scoreboard[f].issue_cycle < entry.issue_cycle) raw_hazard = true;
+	if (raw_hazard){
+		count_hazard_stall(RAW_HAZARD);
+		return false;
+	}
+	unsigned operands[2];
+	for (unsigned s=0; s<2; s++){
+		unsigned reg = entry.src[s];
+		operands[s] = (reg == UNDEFINED) ? 0 : (reg >= NUM_GP_REGISTERS) ? float2unsigned(fp_registers[reg - NUM_GP_REGISTERS]) : int_registers[reg];
+	}
+	unsigned npc = entry.pc + 4;
+	// loads and stores issue their data memory access together with the address computation
+	unsigned memory_ready_cycle = clock_cycles;
+	if (instr.flags & CLASS_MEMORY){
+		entry.address = alu(instr.opcode, operands[0], 0, instr.immediate, npc);
+		memory_ready_cycle = data_memory_issue(entry.address, instr.flags & CLASS_STORE, entry.pc);
+		if (memory_ready_cycle == UNDEFINED) return false;
+	}
+	if (instr.flags & CLASS_LOAD) entry.result = read_memory(entry.address);
+	else if (instr.flags & CLASS_STORE) entry.result = operands[1];
+	else if (instr.flags & CLASS_BRANCH){
+		entry.result = taken_branch(instr.opcode, operands[0]);
+		entry.address = alu(instr.opcode, operands[0], 0, instr.immediate, npc);
+	} else entry.result = alu(instr.opcode, operands[0], operands[1], instr.immediate, npc);
+	entry.ready[0] = entry.ready[1] = false; //operands read
+	entry.completion_cycle = clock_cycles + exec_units[unit].latency + (memory_ready_cycle - clock_cycles);
+	return true;
+}
+
+/* returns true if the instruction in a unit has completed its execution */
+bool sim_pipe_fp::scoreboard_execution_complete(unsigned unit){
+	return scoreboard[unit].completion_cycle != UNDEFINED && scoreboard[unit].completion_cycle <= clock_cycles;
+}
+
+/* scoreboard write result stage: writes the result once no instruction has still to read the old value of the destination register */
+bool sim_pipe_fp::scoreboard_write_result(unsigned unit){
+	scoreboard_entry_t &entry = scoreboard[unit];
+	for (unsigned f=0; f<scoreboard.size(); f++){
+		if (f == unit || !scoreboard[f].busy || entry.dest == UNDEFINED) continue;
+		if ((scoreboard[f].src[0] == entry.dest && scoreboard[f].ready[0]) || (scoreboard[f].src[1] == entry.dest && scoreboard[f].ready[1])){
+			count_hazard_stall(WAR_HAZARD);
+			return false;
+		}
+	}
+	// stores write the data memory after the older loads have read it, and after the older stores have written it
+	const instruction_t &instr = exec_units[unit].instruction;
+	for (unsigned f=0; f<scoreboard.size() && (instr.flags & CLASS_STORE); f++){
+		if (f == unit || !scoreboard[f].busy || scoreboard[f].issue_cycle > entry.issue_cycle) continue;
+		const instruction_t &older = exec_units[f].instruction;
+		if ((older.flags & CLASS_STORE) || ((older.flags & CLASS_LOAD) && scoreboard[f].completion_cycle == UNDEFINED)){
+			count_hazard_stall(WAR_HAZARD);
+			return false;
+		}
+	}
+	if (entry.dest >= NUM_GP_REGISTERS && entry.dest != UNDEFINED) fp_registers[entry.dest - NUM_GP_REGISTERS] = unsigned2float(entry.result);
+	else if (entry.dest != UNDEFINED) int_registers[entry.dest] = entry.result;
+	if (instr.flags & CLASS_STORE) write_memory(entry.address, entry.result);
+	// the issue continues after a branch, from its target if taken
+	if (instr.flags & CLASS_BRANCH){
+		scoreboard_pc = entry.result ? entry.address : entry.pc + 4;
+		scoreboard_fetch_stopped = false;
+	}
+	instructions_executed++;
+	for (unsigned f=0; f<scoreboard.size(); f++){
+		for (unsigned s=0; s<2; s++){
+			if (scoreboard[f].producer[s] == unit){
+				scoreboard[f].producer[s] = UNDEFINED;
+				scoreboard[f].ready[s] = true;
+			}
+		}
+	}
+	if (entry.dest != UNDEFINED) register_producer[entry.dest] = UNDEFINED;
+	entry.busy = false;
+	entry.completion_cycle = UNDEFINED;
+	exec_units[unit].ready_cycle = clock_cycles;
+	sift_unit_up(unit);
+	return true;
+}
+
+/* counts a stall cycle of the scoreboard caused by a hazard */
+void sim_pipe_fp::count_hazard_stall(hazard_t hazard){
+	if (last_hazard_stall[hazard] == clock_cycles) return;
+	hazard_stalls[hazard]++;
+	last_hazard_stall[hazard] = clock_cycles;
+}
+
 /* ========= end primitives related to functional units ===============*/
 
 
-/* ========================parser ==================================== */
+/* ==================== program loading (see program.h) ============== */
+
+/* parses the assembly program in file "filename", and returns it (see attach_program) */
+shared_ptr<const program_t> sim_pipe_fp::read_program(const char *filename){
+   return parse_program(filename, NUM_OPCODES);
+}
 
+/* loads the assembly program in file "filename" in instruction memory at the specified address */
 void sim_pipe_fp::load_program(const char *filename, unsigned base_address){
+   attach_program(read_program(filename), base_address);
+}
 
-   /* initializing the base instruction address */
-   instr_base_address = base_address;
+/* reads the binary program image in file "filename" (see save_binary) - the instructions are used in place from the mapped image */
+shared_ptr<const program_t> sim_pipe_fp::read_binary(const char *filename){
+   return read_program_image(filename, NUM_OPCODES, NUM_GP_REGISTERS);
+}
+
+/* loads the binary program image in file "filename" (see save_binary) in instruction memory at the specified address */
+void sim_pipe_fp::load_binary(const char *filename, unsigned base_address){
+   attach_program(read_binary(filename), base_address);
+}
 
-   /* creating a map with the valid opcodes and with the valid labels */
-   map<string, opcode_t> opcodes; //for opcodes
-   map<string, unsigned> labels;  //for branches
-   for (int i=0; i<NUM_OPCODES; i++)
-	 opcodes[string(instr_names[i])]=(opcode_t)i;
+/* saves the program currently in instruction memory as a binary program image in file "filename" */
+void sim_pipe_fp::save_binary(const char *filename){
 
-   /* opening the assembly file */
-   ifstream fin(filename, ios::in | ios::binary);
-   if (!fin.is_open()) {
-      cerr << "error: open file " << filename << " failed!" << endl;
+   if (program == NULL) {
+      cerr << "error: no program loaded in instruction memory!" << endl;
       exit(-1);
    }
 
-   /* parsing the assembly file line by line */
-   string line;
-   unsigned instruction_nr = 0;
-   while (getline(fin,line)){
-
-	// set the instruction field
-	char *str = const_cast<char*>(line.c_str());
-
-  	// tokenize the instruction
-	char *token = strtok (str," \t");
-	map<string, opcode_t>::iterator search = opcodes.find(token);
-        if (search == opcodes.end()){
-		// this is a label for a branch - extract it and save it in the labels map
-		string label = string(token).substr(0, string(token).length() - 1);
-		labels[label]=instruction_nr;
-                // move to next token, which must be the instruction opcode
-		token = strtok (NULL, " \t");
-		search = opcodes.find(token);
-		if (search == opcodes.end()) cout << "ERROR: invalid opcode: " << token << " !" << endl;
-	}
-	instr_memory[instruction_nr].opcode = search->second;
-
-	//reading remaining parameters
-	char *par1;
-	char *par2;
-	char *par3;
-	switch(instr_memory[instruction_nr].opcode){
-		case ADD:
-		case SUB:
-		case XOR:
-		case ADDS:
-		case SUBS:
-		case MULTS:
-		case DIVS:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			par3 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "RF"));
-			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "RF"));
-			instr_memory[instruction_nr].src2 = atoi(strtok(par3, "RF"));
-			break;
-		case ADDI:
-		case SUBI:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			par3 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "R"));
-			instr_memory[instruction_nr].immediate = strtoul (par3, NULL, 0); 
-			break;
-		case LW:
-		case LWS:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "RF"));
-			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
-			instr_memory[instruction_nr].src1 = atoi(strtok(NULL, "R"));
-			break;
-		case SW:
-		case SWS:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].src2 = atoi(strtok(par1, "RF"));
-			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
-			instr_memory[instruction_nr].src1 = atoi(strtok(NULL, "R"));
-			break;
-		case BEQZ:
-		case BNEZ:
-		case BLTZ:
-		case BGTZ:
-		case BLEZ:
-		case BGEZ:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].src1 = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].label = par2;
-			break;
-		case JUMP:
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].label = par2;
-		default:
-			break;
+   write_program_image(*program, filename);
+}
 
-	} 
+/* attaches the (shared, read-only) program "program" to instruction memory at the specified address */
+void sim_pipe_fp::attach_program(shared_ptr<const program_t> program, unsigned base_address){
+   this->program = program;
+   instr_memory = program->instructions;
+   instr_memory_size = program->num_instructions;
+   instr_base_address = base_address;
+   functional_pc = base_address;
+   sp_registers[IF][PC] = base_address;
+}
 
-	/* increment instruction number before moving to next line */
-	instruction_nr++;
-   }
-   //reconstructing the labels of the branch operations
-   int i = 0;
-   while(true){
-   	instruction_t instr = instr_memory[i];
-	if (instr.opcode == EOP) break;
-	if (instr.opcode == BLTZ || instr.opcode == BNEZ ||
-            instr.opcode == BGTZ || instr.opcode == BEQZ ||
-            instr.opcode == BGEZ || instr.opcode == BLEZ ||
-            instr.opcode == JUMP
-	 ){
-		instr_memory[i].immediate = (labels[instr.label] - i - 1) << 2;
-	}
-        i++;
-   }
+/* returns the program currently in instruction memory (NULL if no program is loaded) */
+shared_ptr<const program_t> sim_pipe_fp::get_program(){
+   return program;
+}
 
+/* returns the instruction at address "pc" in instruction memory - a NOP if "pc" falls outside the loaded program, EOP at the end of the region of interest simulated in detail */
+const instruction_t &sim_pipe_fp::fetch_instruction(unsigned pc){
+	if (pc == roi_end_pc){
+		roi_end_fetched = true;
+		return eop_instruction;
+	}
+	unsigned index = (pc-instr_base_address)>>2;
+	if (pc < instr_base_address || index >= instr_memory_size) return nop_instruction;
+	if (instr_memory[index].opcode == EOP) roi_end_fetched = false;
+	return instr_memory[index];
+}
+
+/* returns the number of clock cycles taken by a data memory access (data_memory_latency if no data caches are configured) */
+unsigned sim_pipe_fp::data_memory_access_latency(unsigned address, bool is_write){
+	return data_memory_hierarchy.access(address, is_write);
+}
+
+/* issues a data memory access in the current clock cycle - returns its completion cycle, or UNDEFINED if it cannot be issued */
+unsigned sim_pipe_fp::data_memory_issue(unsigned address, bool is_write, unsigned pc){
+	unsigned ready_cycle = data_memory_hierarchy.issue(address, is_write, clock_cycles, pc);
+	return (ready_cycle == NOT_ISSUED) ? UNDEFINED : ready_cycle;
 }
 
 /* ======================== execution statistics ==================================== */
@@ -424,8 +682,56 @@ unsigned sim_pipe_fp::get_clock_cycles(){return clock_cycles;}
 
 unsigned sim_pipe_fp::get_instructions_executed(){return instructions_executed;}
 
+unsigned sim_pipe_fp::get_functional_instructions(){return functional_instructions;}
+
 unsigned sim_pipe_fp::get_stalls(){return stalls;}
 
+unsigned sim_pipe_fp::get_skipped_cycles(){return skipped_cycles;}
+
+unsigned sim_pipe_fp::get_cache_hits(cache_level_t level){return data_memory_hierarchy.get_cache_stats(level).hits;}
+
+unsigned sim_pipe_fp::get_cache_misses(cache_level_t level){return data_memory_hierarchy.get_cache_stats(level).misses;}
+
+unsigned sim_pipe_fp::get_cache_evictions(cache_level_t level){return data_memory_hierarchy.get_cache_stats(level).evictions;}
+
+float sim_pipe_fp::get_memory_level_parallelism(){return data_memory_hierarchy.get_memory_level_parallelism();}
+
+unsigned sim_pipe_fp::get_merged_misses(){return data_memory_hierarchy.get_mshr_stats().secondary_misses;}
+
+unsigned sim_pipe_fp::get_mshr_full_stalls(){return data_memory_hierarchy.get_mshr_stats().mshr_full;}
+
+unsigned sim_pipe_fp::get_structural_stalls(exe_unit_t type){return structural_stalls[type];}
+
+unsigned sim_pipe_fp::get_hazard_stalls(hazard_t hazard){return hazard_stalls[hazard];}
+
+unsigned sim_pipe_fp::get_rob_full_stalls(){return tomasulo_stats.rob_full;}
+
+unsigned sim_pipe_fp::get_reservation_station_stalls(){return tomasulo_stats.stations_full;}
+
+unsigned sim_pipe_fp::get_cdb_stalls(){return tomasulo_stats.cdb_stalls;}
+
+unsigned sim_pipe_fp::get_branch_flushes(){return tomasulo_stats.flushes;}
+
+unsigned sim_pipe_fp::get_dram_row_hits(){return data_memory_hierarchy.get_dram_stats().row_hits;}
+
+unsigned sim_pipe_fp::get_dram_row_misses(){return data_memory_hierarchy.get_dram_stats().row_misses;}
+
+unsigned sim_pipe_fp::get_dram_row_conflicts(){return data_memory_hierarchy.get_dram_stats().row_conflicts;}
+
+float sim_pipe_fp::get_prefetch_accuracy(){return data_memory_hierarchy.get_prefetch_accuracy();}
+
+float sim_pipe_fp::get_prefetch_coverage(){return data_memory_hierarchy.get_prefetch_coverage();}
+
+float sim_pipe_fp::get_prefetch_timeliness(){return data_memory_hierarchy.get_prefetch_timeliness();}
+
+unsigned sim_pipe_fp::get_forwarded_loads(){return data_memory_hierarchy.get_store_buffer_stats().forwarded_loads;}
+
+unsigned sim_pipe_fp::get_store_buffer_full_stalls(){return data_memory_hierarchy.get_store_buffer_stats().full_stalls;}
+
+unsigned sim_pipe_fp::get_forwarded_operands(forwarding_path_t path){return forwarding.get_forwarded_operands(path);}
+
+unsigned sim_pipe_fp::get_forwarding_saved_stalls(forwarding_path_t path){return forwarding.get_saved_stalls(path);}
+
 float sim_pipe_fp::get_IPC(){return (float)instructions_executed/clock_cycles;}
 
 
@@ -438,86 +744,668 @@ float sim_pipe_fp::get_IPC(){return (float)instructions_executed/clock_cycles;}
 //reset the state of the sim_pipe_fpulator
 void sim_pipe_fp::reset(){
 
-        // initializing data memory to all 0xFF
-        for (unsigned i=0; i<data_memory_size; i++) data_memory[i]=0xFF;
+        // initializing data memory to all 0xFF (in O(1), see paged_memory::reset)
+        data_memory.reset();
+
+        // emptying the data caches (their configuration is preserved)
+        data_memory_hierarchy.reset();
+
+        // clearing the forwarding statistics (the forwarding network is preserved)
+        forwarding.reset();
 
         // initializing instuction memory
-        for (int i=0; i<PROGRAM_SIZE;i++){
-                instr_memory[i].opcode=(opcode_t)NOP;
-                instr_memory[i].src1=UNDEFINED;
-                instr_memory[i].src2=UNDEFINED;
-                instr_memory[i].dest=UNDEFINED;
-                instr_memory[i].immediate=UNDEFINED;
-        }
+        program.reset();
+        instr_memory = NULL;
+        instr_memory_size = 0;
         instr_base_address = UNDEFINED;
+        functional_pc = UNDEFINED;
+        functional_instructions = 0;
+        roi_end_pc = UNDEFINED;
+        roi_end_fetched = false;
 
         // general purpose registers initialization
-        // <TODO: add initialization code for integer and floating point registers here>
+        for (unsigned r=0; r<NUM_GP_REGISTERS; r++){
+                int_registers[r] = UNDEFINED;
+                fp_registers[r] = UNDEFINED;
+        }
 
         // pipeline registers initialization
-        // <TODO: add initialization code here, you can reuse code from your integer pipeline>
+        for (int s=0; s<NUM_STAGES; s++)
+                for (int r=0; r<NUM_SP_REGISTERS; r++) sp_registers[s][r] = UNDEFINED;
+        exe_instructions.clear();
+        memory_ready_cycle = UNDEFINED;
 
         // IR initialization
         for (int i=0; i<NUM_STAGES-1; i++){
                 ir[i].opcode=(opcode_t)NOP;
-                ir[i].src1=UNDEFINED;
-                ir[i].src2=UNDEFINED;
-                ir[i].dest=UNDEFINED;
+                ir[i].src1=UNDEFINED_REGISTER;
+                ir[i].src2=UNDEFINED_REGISTER;
+                ir[i].dest=UNDEFINED_REGISTER;
                 ir[i].immediate=UNDEFINED;
+                ir[i].target=UNDEFINED;
+                ir[i].flags=0;
+                ir_pc[i]=UNDEFINED;
         }
 
+        // execution units initialization (all free, since the clock cycles restart from 0)
+        for (unsigned u=0; u<exec_units.size(); u++){
+                exec_units[u].ready_cycle = 0;
+                exec_units[u].instruction.opcode = NOP;
+                exec_units[u].oldest_completion = 0;
+                exec_units[u].in_flight = 0;
+        }
+        for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+                structural_stalls[t] = 0;
+                last_structural_stall[t] = UNDEFINED;
+        }
+
+        // scoreboard initialization (all units idle, no register waiting for a result)
+        for (unsigned u=0; u<scoreboard.size(); u++){
+                scoreboard[u].busy = false;
+                scoreboard[u].completion_cycle = UNDEFINED;
+        }
+        for (unsigned r=0; r<SCOREBOARD_REGISTERS; r++) register_producer[r] = UNDEFINED;
+        scoreboard_pc = UNDEFINED;
+        scoreboard_fetch_stopped = false;
+        for (unsigned h=0; h<NUM_HAZARD_TYPES; h++){
+                hazard_stalls[h] = 0;
+                last_hazard_stall[h] = UNDEFINED;
+        }
+
+        // Tomasulo engine initialization (its configuration is preserved)
+        tomasulo_flush();
+        tomasulo_pc = UNDEFINED;
+        tomasulo_done = false;
+        tomasulo_stats.rob_full = 0;
+        tomasulo_stats.stations_full = 0;
+        tomasulo_stats.cdb_stalls = 0;
+        tomasulo_stats.flushes = 0;
+
         // other required initializations (statistics, etc.)
         clock_cycles = 0; //clock cycles
         stalls = 0; //stalls
         instructions_executed = 0; //instruction count
+        skipped_cycles = 0;
 
 }
 
 //returns value of special purpose register (see sim_pipe.h for more details)
 unsigned sim_pipe_fp::get_sp_register(sp_register_t reg, stage_t s){
-	return 0; // <TODO: please modify, you can copy the code from your integer pipeline>
+	return sp_registers[s][reg];
 }
 
 //returns value of integer register
 int sim_pipe_fp::get_int_register(unsigned reg){
-	return 0; // <TODO: please modify, you can copy the code from your integer pipeline>
+	return int_registers[reg];
 }
 
 // sets value of integer register
 void sim_pipe_fp::set_int_register(unsigned reg, int value){
-	// <TODO: please modify, you can copy the code from your integer pipeline>
+	int_registers[reg] = value;
 }
 
 //returs the value of floating point register
 float sim_pipe_fp::get_fp_register(unsigned reg){
-	return 0.0; // <TODO: please modify>
+	return fp_registers[reg];
 }
 
 //sets the value of floating point register
 void sim_pipe_fp::set_fp_register(unsigned reg, float value){
-	// <TODO: please modify>
+	fp_registers[reg] = value;
 }
 
-/* <TODO: BODY OF THE SIMULATOR */
-/*
+/* executes instructions functionally (architecturally, without modeling the pipeline), stopping after "instructions" instructions (if not 0), before EOP, or before "stop_pc" */
+unsigned sim_pipe_fp::execute_functional(unsigned instructions, unsigned stop_pc){
+	// architectural state: the registers are copied in from (and back to) the simulator
+	// (floating point registers are kept in their binary representation, as in the pipeline registers)
+	unsigned int_regs[NUM_GP_REGISTERS];
+	unsigned fp_regs[NUM_GP_REGISTERS];
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++){
+		int_regs[r] = get_int_register(r);
+		fp_regs[r] = float2unsigned(get_fp_register(r));
+	}
 
-How to proceed:
-(1) Copy and paste your integer pipeline simulator (i.e., "run" function) here;
-(2) Modify (i.e., extend) the pipeline stages to support multicycle floating-point execution.
+	unsigned pc = functional_pc;
+	unsigned executed = 0;
+	while ((instructions == 0 || executed != instructions) && pc != stop_pc){
+		const instruction_t &instr = fetch_instruction(pc);
+		if (instr.opcode == EOP) break;
+		unsigned npc = pc + 4;
+		if (instr.flags & CLASS_FP_ALU){
+			fp_regs[instr.dest] = alu(instr.opcode, fp_regs[instr.src1], fp_regs[instr.src2], instr.immediate, npc);
+		} else if (instr.flags & CLASS_INT_R){
+			int_regs[instr.dest] = alu(instr.opcode, int_regs[instr.src1], int_regs[instr.src2], instr.immediate, npc);
+		} else if (instr.flags & CLASS_INT_IMM){
+			int_regs[instr.dest] = alu(instr.opcode, int_regs[instr.src1], 0, instr.immediate, npc);
+		} else if (instr.flags & CLASS_LOAD){
+			unsigned value = read_memory(alu(instr.opcode, int_regs[instr.src1], 0, instr.immediate, npc));
+			if (instr.flags & CLASS_FP) fp_regs[instr.dest] = value;
+			else int_regs[instr.dest] = value;
+		} else if (instr.flags & CLASS_STORE){
+			write_memory(alu(instr.opcode, int_regs[instr.src1], 0, instr.immediate, npc), (instr.flags & CLASS_FP) ? fp_regs[instr.src2] : int_regs[instr.src2]);
+		} else if (instr.flags & CLASS_BRANCH){
+			if (taken_branch(instr.opcode, int_regs[instr.src1])) npc = alu(instr.opcode, int_regs[instr.src1], 0, instr.immediate, npc);
+		}
+		pc = npc;
+		executed++;
+	}
+
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++){
+		set_int_register(r, int_regs[r]);
+		set_fp_register(r, unsigned2float(fp_regs[r]));
+	}
+	functional_pc = pc;
+	functional_instructions += executed;
+	return executed;
+}
+
+unsigned sim_pipe_fp::run_functional(unsigned instructions){
+	return execute_functional(instructions, UNDEFINED);
+}
+
+void sim_pipe_fp::run_roi(){
+	if (program == NULL){
+		cerr << "error: no program loaded in instruction memory!" << endl;
+		exit(-1);
+	}
 
-Most of your modifications will be in the code implementing the following stages:
-- ID: decoding of floating-point instructions and hazard handling
-- EXE: multicycle execution 
+	// fast-forward to the beginning of the region of interest
+	if (program->roi_begin != UNDEFINED) execute_functional(0, instr_base_address + (program->roi_begin << 2));
 
-You will need to make minor modifications to the MEM and WB stage to include the added floating-point instructions.
+	// detailed simulation of the region of interest, which ends with an EOP in place of .roi_end
+	if (program->roi_end != UNDEFINED) roi_end_pc = instr_base_address + (program->roi_end << 2);
+	roi_end_fetched = false;
+	run();
+	roi_end_pc = UNDEFINED;
 
-For multicycle execution, you can use the provided unit_t data structure and its helper functions. In particular:
-(a) invoke "get_free_unit" to obtain a functional unit to execute the considered instruction. This function returns the identifier of a free execution unit, and UNDEFINED if all the units of the specified type are unavailable (structural hazard).
-(b) if a unit u is available, set exec_units[u].instruction to the current instruction, and exec_units[u].busy to exec_units[u].latency. This will make the considered execution unit busy for latency clock cycles.
-(c) invoke "decrement_units_busy_time" at the end of the clock cycle (i.e., in the bookkeeping code at the end of the simulator iteration). This will decrement the busy field of all active execution units. Once the busy field becomes 0, the instruction being executed is free from structural hazard.
+	// functional execution of the rest of the program, unless run() has stopped at the actual end of the program
+	// (e.g., a branch leaving the region of interest)
+	if (roi_end_fetched){
+		functional_pc = instr_base_address + (program->roi_end << 2);
+		execute_functional(0, UNDEFINED);
+	}
+}
+
+unsigned sim_pipe_fp::get_functional_pc(){
+	return functional_pc;
+}
 
-Note that pipeline registers can store either integer or floating-point values. As a result, conversions between unsigned and floating-point values are required when handling floating-point data. To this end, you can use the provided "float2unsigned" and "unsigned2float" helper functions (these functions are invoked in the "alu" function already).
+/* runs the scoreboard for "cycles" clock cycles (to completion if cycles=0) */
+void sim_pipe_fp::run_scoreboard(unsigned cycles){
+
+	unsigned start_cycles = clock_cycles;
+
+	/* initialization at the beginning of simulation */
+	if (clock_cycles == 0) scoreboard_pc = get_functional_pc();
+
+	/* stages processed in reverse order, so that an instruction moves through at most one of them per clock cycle */
+	while (cycles==0 || clock_cycles-start_cycles!=cycles){
+
+		bool busy = false;
+		for (unsigned u=0; u<scoreboard.size(); u++) busy |= scoreboard[u].busy;
+		if (!busy && fetch_instruction(scoreboard_pc).opcode == EOP) break;
+
+		// write result, then execute (completion) and read operands
+		for (unsigned u=0; u<scoreboard.size(); u++)
+			if (scoreboard[u].busy && scoreboard_execution_complete(u)) scoreboard_write_result(u);
+		for (unsigned u=0; u<scoreboard.size(); u++)
+			if (scoreboard[u].busy) scoreboard_read_operands(u);
+
+		// issue (NOPs are skipped, EOP waits until all the units are free)
+		const instruction_t &next = fetch_instruction(scoreboard_pc);
+		unsigned unit;
+		if (scoreboard_fetch_stopped){
+			stalls++;
+		} else if (next.opcode == NOP){
+			scoreboard_pc += 4;
+		} else if (next.opcode != EOP){
+			if (!scoreboard_issue(next, scoreboard_pc, unit)) stalls++;
+			else if (next.flags & CLASS_BRANCH) scoreboard_fetch_stopped = true;
+			else scoreboard_pc += 4;
+		}
+
+		clock_cycles++; // increase clock cycles count
+	}
+}
 
+/* ============== Tomasulo engine (see init_tomasulo) ================== */
+
+/* empties the ROB and the reservation stations */
+void sim_pipe_fp::tomasulo_flush(){
+	rob_head = 0;
+	rob_count = 0;
+	for (unsigned s=0; s<stations.size(); s++){
+		stations[s].busy = false;
+		stations[s].completion_cycle = UNDEFINED;
+		stations[s].cdb_stalled = false;
+	}
+	for (unsigned r=0; r<SCOREBOARD_REGISTERS; r++) register_tag[r] = UNDEFINED;
+	tomasulo_fetch_stopped = false;
+}
+
+/* commit stage: the oldest instructions leave the ROB in program order, updating the architectural state */
+bool sim_pipe_fp::tomasulo_commit(){
+	for (unsigned c=0; c<commit_width && rob_count != 0 && rob[rob_head].ready; c++){
+		rob_entry_t &entry = rob[rob_head];
+		if (entry.instruction.opcode == EOP) return true;
+		if (entry.dest != UNDEFINED){
+			architectural_registers[entry.dest] = entry.value;
+			if (register_tag[entry.dest] == rob_head) register_tag[entry.dest] = UNDEFINED;
+		}
+		if (entry.instruction.flags & CLASS_STORE) write_memory(entry.address, entry.value);
+		if (entry.instruction.opcode != NOP) instructions_executed++;
+		rob_head = (rob_head + 1) % rob.size();
+		rob_count--;
+		if (entry.taken && entry.instruction.opcode != JUMP){
+			tomasulo_flush();
+			tomasulo_pc = entry.address;
+			tomasulo_stats.flushes++;
+			break;
+		}
+	}
+	return false;
+}
+
+/* execute stage: the instructions with all their operands available start executing, oldest first */
+void sim_pipe_fp::tomasulo_execute(){
+	bool older_store = false;
+	for (unsigned i=0; i<rob_count; i++){
+		rob_entry_t &entry = rob[(rob_head + i) % rob.size()];
+		const instruction_t &instr = entry.instruction;
+		if (entry.station != UNDEFINED){
+			reservation_station_t &station = stations[entry.station];
+			bool waiting = station.tag[0] != UNDEFINED || station.tag[1] != UNDEFINED || ((instr.flags & CLASS_LOAD) && older_store);
+			if (station.completion_cycle == UNDEFINED && !waiting){
+				unsigned u = get_free_unit(instr.opcode);
+				unsigned npc = entry.pc + 4;
+				// loads and stores issue their data memory access together with the address computation, and complete once both are done
+				// (the instruction does not start if the access cannot be issued in this clock cycle)
+				unsigned memory_ready_cycle = clock_cycles;
+				if (u != UNDEFINED && (instr.flags & CLASS_MEMORY)){
+					entry.address = alu(instr.opcode, station.value[0], 0, instr.immediate, npc);
+					memory_ready_cycle = data_memory_issue(entry.address, instr.flags & CLASS_STORE, entry.pc);
+					if (memory_ready_cycle == UNDEFINED) u = UNDEFINED;
+				}
+				if (u != UNDEFINED){
+					station.completion_cycle = start_unit(u, instr) + (memory_ready_cycle - clock_cycles);
+					if (instr.flags & CLASS_MEMORY){
+						station.result = (instr.flags & CLASS_LOAD) ? read_memory(entry.address) : station.value[1];
+					} else if (instr.flags & CLASS_BRANCH){
+						entry.taken = taken_branch(instr.opcode, station.value[0]);
+						entry.address = alu(instr.opcode, station.value[0], 0, instr.immediate, npc);
+						station.result = 0;
+					} else station.result = alu(instr.opcode, station.value[0], station.value[1], instr.immediate, npc);
+				}
+			}
+		}
+		if (instr.flags & CLASS_STORE) older_store = true;
+	}
+}
+
+/* write result stage: up to cdb_width completed instructions, oldest first, broadcast their result on the CDB */
+void sim_pipe_fp::tomasulo_write_result(){
+	unsigned broadcast = 0;
+	for (unsigned i=0; i<rob_count; i++){
+		unsigned tag = (rob_head + i) % rob.size();
+		rob_entry_t &entry = rob[tag];
+		if (entry.station == UNDEFINED || stations[entry.station].completion_cycle > clock_cycles) continue;
+		if (broadcast == cdb_width){
+			if (!stations[entry.station].cdb_stalled) tomasulo_stats.cdb_stalls++;
+			stations[entry.station].cdb_stalled = true;
+			continue;
+		}
+		reservation_station_t &station = stations[entry.station];
+		entry.value = station.result;
+		entry.ready = true;
+		for (unsigned s=0; s<stations.size(); s++){
+			for (unsigned o=0; o<2; o++){
+				if (stations[s].busy && stations[s].tag[o] == tag){
+					stations[s].value[o] = station.result;
+					stations[s].tag[o] = UNDEFINED;
+				}
+			}
+		}
+		station.busy = false;
+		station.completion_cycle = UNDEFINED;
+		entry.station = UNDEFINED;
+		broadcast++;
+	}
+}
+
+/* issue stage: the next instruction takes a ROB entry and a reservation station, and its source registers are renamed */
+void sim_pipe_fp::tomasulo_issue(){
+	if (tomasulo_fetch_stopped) return;
+	if (rob_count == rob.size()){
+		tomasulo_stats.rob_full++;
+		stalls++;
+		return;
+	}
+	const instruction_t &instr = fetch_instruction(tomasulo_pc);
+	bool needs_station = (instr.flags != 0 && instr.opcode != JUMP);
+	unsigned s = UNDEFINED;
+	if (needs_station){
+		unsigned type = opcode_unit[instr.opcode];
+		if (station_begin[type] == station_begin[type+1] || unit_begin[type] == unit_begin[type+1]){
+			cerr << "error: no " << unit_names[type] << " reservation station or execution unit for " << instr_names[instr.opcode] << "!" << endl;
+			exit(-1);
+		}
+		for (unsigned f=station_begin[type]; f<station_begin[type+1] && s == UNDEFINED; f++)
+			if (!stations[f].busy) s = f;
+		if (s == UNDEFINED){
+			tomasulo_stats.stations_full++;
+			stalls++;
+			return;
+		}
+	}
+	unsigned tag = (rob_head + rob_count) % rob.size();
+	rob_entry_t &entry = rob[tag];
+	entry.instruction = instr;
+	entry.pc = tomasulo_pc;
+	entry.station = s;
+	entry.dest = destination_register(instr);
+	entry.ready = !needs_station;
+	entry.value = 0;
+	entry.address = 0;
+	entry.taken = (instr.opcode == JUMP);
+	rob_count++;
+	if (needs_station){
+		reservation_station_t &station = stations[s];
+		station.busy = true;
+		station.rob = tag;
+		station.completion_cycle = UNDEFINED;
+		station.cdb_stalled = false;
+		for (unsigned o=0; o<2; o++){
+			unsigned reg = source_register(instr, o);
+			station.value[o] = 0;
+			station.tag[o] = UNDEFINED;
+			if (reg == UNDEFINED) continue;
+			if (register_tag[reg] == UNDEFINED) station.value[o] = architectural_registers[reg];
+			else if (rob[register_tag[reg]].ready) station.value[o] = rob[register_tag[reg]].value;
+			else station.tag[o] = register_tag[reg];
+		}
+		if (entry.dest != UNDEFINED) register_tag[entry.dest] = tag;
+	}
+	if (instr.opcode == EOP) tomasulo_fetch_stopped = true;
+	tomasulo_pc = (instr.opcode == JUMP) ? tomasulo_pc + 4 + instr.immediate : tomasulo_pc + 4;
+}
+
+/* runs the Tomasulo engine for "cycles" clock cycles (to completion if cycles=0) */
+void sim_pipe_fp::run_tomasulo(unsigned cycles){
+
+	unsigned start_cycles = clock_cycles;
+
+	/* initialization at the beginning of simulation: the register file is copied in from the simulator */
+	if (clock_cycles == 0){
+		tomasulo_pc = get_functional_pc();
+		for (unsigned r=0; r<NUM_GP_REGISTERS; r++){
+			architectural_registers[r] = get_int_register(r);
+			architectural_registers[NUM_GP_REGISTERS + r] = float2unsigned(get_fp_register(r));
+		}
+	}
+
+	/* stages processed in reverse order, so that each of them sees the state left by the following ones in the previous clock cycle */
+	while (!tomasulo_done && (cycles==0 || clock_cycles-start_cycles!=cycles)){
+		tomasulo_done = tomasulo_commit();
+		if (!tomasulo_done){
+			tomasulo_execute();
+			tomasulo_write_result();
+			tomasulo_issue();
+		}
+		clock_cycles++;
+	}
+
+	/* the committed register file is copied back to the simulator */
+	for (unsigned r=0; r<NUM_GP_REGISTERS; r++){
+		set_int_register(r, architectural_registers[r]);
+		set_fp_register(r, unsigned2float(architectural_registers[NUM_GP_REGISTERS + r]));
+	}
+}
+
+/* returns the value of register "reg" (numbered as by destination_register) for the instruction entering EXE, with forwarding */
+unsigned sim_pipe_fp::forwarded_operand(unsigned reg, unsigned value){
+	if (reg == UNDEFINED) return value;
+	// EX/MEM -> EX: the producer has just moved on to MEM/WB
+	const instruction_t &producer = ir[WB-1];
+	if (destination_register(producer) == reg) return (producer.flags & CLASS_LOAD) ? sp_registers[WB][LMD] : sp_registers[WB][ALU_OUTPUT];
+	// MEM/WB -> EX, or no hazard: WB has just written the register file
+	return (reg >= NUM_GP_REGISTERS) ? float2unsigned(fp_registers[reg - NUM_GP_REGISTERS]) : int_registers[reg];
+}
+
+/* empties the special purpose registers of a pipeline register (bubble) */
+static void clear_sp_registers(unsigned *registers){
+	for (unsigned r=0; r<NUM_SP_REGISTERS; r++) registers[r] = UNDEFINED;
+}
+
+/* BODY OF THE SIMULATOR */
+/*
+In-order pipeline with multicycle execution:
+- ID issues one instruction per clock cycle, in order, once its source operands are in the register file (RAW hazards),
+  an execution unit of its type is free (structural hazards), and it would complete after any older instruction in EXE
+  writing the same register (WAW hazards)
+- the instruction issued enters EXE in the next clock cycle, starting on its execution unit, and leaves it once completed:
+  instructions can complete out of order, but only one per clock cycle enters EX/MEM (the oldest completed one)
+- EOP waits in ID/EX until all the older instructions have left EXE
+- branches stall the fetch until they are resolved in MEM, and a data memory access stalls the stages before MEM until it completes
+In scoreboard mode (see init_scoreboard) and with the Tomasulo engine (see init_tomasulo), run() uses the corresponding engine.
 */
+// Note: processing the stages in reverse order simplifies the data propagation through pipeline registers
 void sim_pipe_fp::run(unsigned cycles){
+
+	/* dynamic scheduling (see init_tomasulo and init_scoreboard) */
+	if (tomasulo){
+		run_tomasulo(cycles);
+		return;
+	}
+	if (scoreboarding){
+		run_scoreboard(cycles);
+		return;
+	}
+
+	unsigned start_cycles = clock_cycles;
+
+	/* initialization at the beginning of simulation */
+	if (clock_cycles == 0){
+		// instr_base_address, or the PC reached by "run_functional" if the program has been fast-forwarded
+		sp_registers[IF][PC] = get_functional_pc();
+	}
+
+	/* ====== MAIN SIMULATION LOOP (one iteration per clock cycle)  ========= */
+	while(cycles==0 || clock_cycles-start_cycles!=cycles){
+
+		bool memory_stall = false; //the stages before MEM wait for a data memory access
+		bool id_ex_free = false; //the instruction in ID/EX has entered EXE, so that ID can issue the next one
+		bool id_stall = false; //the instruction in ID cannot be issued in this clock cycle
+		bool moved = false; //some instruction has moved through the pipeline in this clock cycle
+		unsigned waw_ready_cycle = UNDEFINED; //clock cycle at which the WAW hazard stalling ID is cleared
+		unsigned cycle_stalls = stalls;
+
+		unsigned *if_id = sp_registers[ID], *id_ex = sp_registers[EXE], *ex_mem = sp_registers[MEM], *mem_wb = sp_registers[WB];
+
+                /* =============== */
+                /* PIPELINE STAGES */
+                /* =============== */
+
+		/* ============   WB stage   ============  */
+
+		const instruction_t &wb_instr = ir[WB-1];
+		if (wb_instr.opcode == EOP) break;
+		if (wb_instr.dest != UNDEFINED_REGISTER){
+			unsigned value = (wb_instr.flags & CLASS_LOAD) ? mem_wb[LMD] : mem_wb[ALU_OUTPUT];
+			if (wb_instr.flags & CLASS_FP) fp_registers[wb_instr.dest] = unsigned2float(value);
+			else int_registers[wb_instr.dest] = value;
+		}
+		if (wb_instr.opcode != NOP){
+			instructions_executed++;
+			moved = true;
+		}
+
+		/* ============   MEM stage   ===========  */
+
+		const instruction_t &mem_instr = ir[MEM-1];
+		// the data memory access is issued in the first clock cycle the instruction spends in MEM (or retried, if it could not be issued),
+		// and the pipeline stalls until it completes
+		if ((mem_instr.flags & CLASS_MEMORY) && memory_ready_cycle == UNDEFINED)
+			memory_ready_cycle = data_memory_issue(ex_mem[ALU_OUTPUT], mem_instr.flags & CLASS_STORE, ir_pc[MEM-1]);
+		if ((mem_instr.flags & CLASS_MEMORY) && (memory_ready_cycle == UNDEFINED || clock_cycles < memory_ready_cycle)){
+			memory_stall = true;
+			stalls++;
+			ir[WB-1] = nop_instruction;
+			ir_pc[WB-1] = UNDEFINED;
+			clear_sp_registers(mem_wb);
+		} else {
+			ir[WB-1] = mem_instr;
+			ir_pc[WB-1] = ir_pc[MEM-1];
+			if (mem_instr.opcode != NOP) moved = true;
+			clear_sp_registers(mem_wb);
+			mem_wb[ALU_OUTPUT] = ex_mem[ALU_OUTPUT];
+			if (mem_instr.flags & CLASS_LOAD) mem_wb[LMD] = read_memory(ex_mem[ALU_OUTPUT]);
+			// with forwarding, the data of a store is read when it is used (MEM/WB -> MEM): WB has just written the register file
+			if (mem_instr.flags & CLASS_STORE){
+				unsigned data = ex_mem[B];
+				if (forwarding.is_enabled()) data = (mem_instr.flags & CLASS_FP) ? float2unsigned(fp_registers[mem_instr.src2]) : int_registers[mem_instr.src2];
+				write_memory(ex_mem[ALU_OUTPUT], data);
+			}
+			// branches are resolved here: the IF stage (processed next) fetches from the target of a taken branch
+			if ((mem_instr.flags & CLASS_BRANCH) && ex_mem[COND]) sp_registers[IF][PC] = ex_mem[ALU_OUTPUT];
+			memory_ready_cycle = UNDEFINED;
+		}
+
+		/* ============   EXE stage   ===========  */
+
+		if (!memory_stall){
+			const instruction_t &ex_instr = ir[EXE-1];
+			// the instruction issued in the previous clock cycle starts on its execution unit (left free by ID)
+			if (ex_instr.opcode != NOP && ex_instr.opcode != EOP){
+				exe_instruction_t exe;
+				exe.instruction = ex_instr;
+				exe.pc = ir_pc[EXE-1];
+				unsigned a = id_ex[A], b = id_ex[B];
+				if (forwarding.is_enabled()){
+					a = forwarded_operand(source_register(ex_instr, 0), a);
+					if (!(ex_instr.flags & CLASS_STORE)) b = forwarded_operand(source_register(ex_instr, 1), b);
+				}
+				exe.b = b;
+				exe.alu_output = alu(ex_instr.opcode, a, b, id_ex[IMM], id_ex[NPC]);
+				exe.cond = (ex_instr.flags & CLASS_BRANCH) ? taken_branch(ex_instr.opcode, a) : UNDEFINED;
+				exe.completion_cycle = start_unit(get_free_unit(ex_instr.opcode), ex_instr);
+				exe_instructions.push_back(exe);
+				moved = true;
+			}
+			id_ex_free = (ex_instr.opcode != EOP);
+
+			// the oldest completed instruction leaves EXE
+			ir[MEM-1] = nop_instruction;
+			ir_pc[MEM-1] = UNDEFINED;
+			clear_sp_registers(ex_mem);
+			unsigned i = 0;
+			while (i < exe_instructions.size() && exe_instructions[i].completion_cycle > clock_cycles) i++;
+			if (i < exe_instructions.size()){
+				const exe_instruction_t &exe = exe_instructions[i];
+				ir[MEM-1] = exe.instruction;
+				ir_pc[MEM-1] = exe.pc;
+				ex_mem[B] = exe.b;
+				ex_mem[ALU_OUTPUT] = exe.alu_output;
+				ex_mem[COND] = exe.cond;
+				exe_instructions.erase(exe_instructions.begin() + i);
+				moved = true;
+			} else if (ex_instr.opcode == EOP && exe_instructions.empty()){
+				ir[MEM-1] = ex_instr;
+				id_ex_free = true;
+				moved = true;
+			}
+		}
+
+		/* ============   ID stage   ============  */
+
+		if (id_ex_free){
+			const instruction_t &id_instr = ir[ID-1];
+			forwarding_path_t paths[2] = {PATH_REGISTER_FILE, PATH_REGISTER_FILE};
+			unsigned producer_stages[2] = {WB, WB};
+			if (id_instr.opcode != NOP && id_instr.opcode != EOP){
+				// RAW hazards with the older instructions in EXE and MEM (the ones in WB have already written the register file):
+				// each operand comes from the youngest of them writing its register, through the forwarding network once it has left EXE
+				for (unsigned o=0; o<2; o++){
+					unsigned src = source_register(id_instr, o);
+					if (src == UNDEFINED) continue;
+					for (unsigned i=0; i<exe_instructions.size(); i++)
+						if (destination_register(exe_instructions[i].instruction) == src) paths[o] = PATH_STALL;
+					for (unsigned s=MEM; s<=WB && paths[o] != PATH_STALL; s++){
+						if (destination_register(ir[s-1]) != src) continue;
+						producer_stages[o] = s-1;
+						paths[o] = forwarding.path(s-1, (ir[s-1].flags & CLASS_LOAD) ? MEM : EXE, (o == 1 && (id_instr.flags & CLASS_STORE)) ? MEM : EXE);
+						break;
+					}
+					if (paths[o] == PATH_STALL) id_stall = true;
+				}
+				// structural hazards: a unit has to be free when the instruction enters EXE
+				unsigned unit = id_stall ? UNDEFINED : get_free_unit(id_instr.opcode);
+				if (unit == UNDEFINED) id_stall = true;
+				// WAW hazards: the instruction has to complete after the older ones writing the same register
+				unsigned dest = destination_register(id_instr);
+				for (unsigned i=0; i<exe_instructions.size() && !id_stall && dest != UNDEFINED; i++){
+					if (destination_register(exe_instructions[i].instruction) == dest && exe_instructions[i].completion_cycle >= clock_cycles + 1 + exec_units[unit].latency){
+						id_stall = true;
+						waw_ready_cycle = exe_instructions[i].completion_cycle - exec_units[unit].latency;
+					}
+				}
+			}
+			clear_sp_registers(id_ex);
+			if (id_stall){
+				stalls++;
+				ir[EXE-1] = nop_instruction;
+				ir_pc[EXE-1] = UNDEFINED;
+			} else {
+				ir[EXE-1] = id_instr;
+				ir_pc[EXE-1] = ir_pc[ID-1];
+				forwarding.count(paths, producer_stages);
+				if (id_instr.opcode != NOP) moved = true;
+				id_ex[NPC] = if_id[NPC];
+				if (id_instr.src1 != UNDEFINED_REGISTER) id_ex[A] = (id_instr.flags & CLASS_FP_ALU) ? float2unsigned(fp_registers[id_instr.src1]) : int_registers[id_instr.src1];
+				if (id_instr.src2 != UNDEFINED_REGISTER) id_ex[B] = (id_instr.flags & CLASS_FP) ? float2unsigned(fp_registers[id_instr.src2]) : int_registers[id_instr.src2];
+				id_ex[IMM] = id_instr.immediate;
+			}
+		}
+
+		/* ============   IF stage   ============  */
+
+		if (id_ex_free && !id_stall){
+			unsigned &pc = sp_registers[IF][PC];
+			bool branch_in_flight = (ir[EXE-1].flags & CLASS_BRANCH) || (ir[MEM-1].flags & CLASS_BRANCH);
+			for (unsigned i=0; i<exe_instructions.size(); i++)
+				if (exe_instructions[i].instruction.flags & CLASS_BRANCH) branch_in_flight = true;
+			clear_sp_registers(if_id);
+			if (branch_in_flight){
+				// the fetch waits until the branch is resolved
+				stalls++;
+				ir[ID-1] = nop_instruction;
+				ir_pc[ID-1] = UNDEFINED;
+			} else {
+				const instruction_t &instr = fetch_instruction(pc);
+				ir[ID-1] = instr;
+				ir_pc[ID-1] = pc;
+				if (instr.opcode != EOP) pc += 4;
+				if_id[NPC] = pc;
+				moved = true;
+			}
+		}
+
+                /* =============== */
+                /* END STAGES      */
+                /* =============== */
+
+		/* Other bookkeeping code */
+                /* ====================== */
+
+		clock_cycles++; // increase clock cycles count
+
+		// nothing has moved and a single stall has been counted: the following clock cycles are the same stall, until an instruction
+		// in EXE or the data memory access completes, an execution unit becomes free, or the WAW hazard is cleared
+		if (cycle_skipping && !moved && stalls == cycle_stalls + 1 && !(memory_stall && memory_ready_cycle == UNDEFINED)){
+			unsigned next_cycle = memory_stall ? memory_ready_cycle : waw_ready_cycle;
+			for (unsigned i=0; i<exe_instructions.size(); i++) next_cycle = min(next_cycle, exe_instructions[i].completion_cycle);
+			unsigned idle = idle_unit_cycles();
+			if (idle != UNDEFINED) next_cycle = min(next_cycle, clock_cycles + idle);
+			if (next_cycle != UNDEFINED && next_cycle > clock_cycles) skip_idle_cycles(next_cycle - clock_cycles, cycles, start_cycles);
+		}
+	}
 }
@@ -6,27 +6,31 @@ Email: tutorcs@163.com
 
 #include <stdio.h>
 #include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include "paged_memory.h"
+#include "memory_hierarchy.h"
+#include "forwarding.h"
+#include "program.h"
 
 using namespace std;
 
-#define PROGRAM_SIZE 50
 
-#define UNDEFINED 0xFFFFFFFF
 #define NUM_SP_REGISTERS 9
 #define NUM_SP_INT_REGISTERS 15
 #define NUM_GP_REGISTERS 32
 #define NUM_OPCODES 22
 #define NUM_STAGES 5
-#define MAX_UNITS 10
 
 typedef enum {PC, NPC, IR, A, B, IMM, COND, ALU_OUTPUT, LMD} sp_register_t;
 
-typedef enum {LW, SW, ADD, ADDI, SUB, SUBI, XOR, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, NOP, LWS, SWS, ADDS, SUBS, MULTS, DIVS} opcode_t;
-
 typedef enum {IF, ID, EXE, MEM, WB} stage_t;
 
 typedef enum {INTEGER, ADDER, MULTIPLIER, DIVIDER} exe_unit_t;
 
+#define NUM_UNIT_TYPES 4
+
 /*
 Instruction encoding:
 ADD <dest> <src1> <src2>
@@ -34,37 +38,139 @@ ADDI <dest> <src1> <immediate>
 LW <dest> <immediate>(<src1>)
 SW <src2> <immediate>(<src1>)
 BRANCH <src1> <immediate>
+
+Instructions are pre-decoded by load_program into a compact, trivially-copyable form,
+so that fetching and advancing them through the pipeline latches is a plain copy.
+Branch labels are resolved at load time and kept in a separate symbol table.
+
+Region of interest (ROI): the directives ".roi_begin" and ".roi_end", each on a line of its own (optionally
+after a label), mark the beginning and the end of the region of the program to be simulated in detail (see run_roi).
 */
-typedef struct{
-        opcode_t opcode; //opcode
-        unsigned src1; //source register #1 - see instruction encoding above 
-        unsigned src2; //source register #2 - see instruction encoding above
-        unsigned dest; //destination register
-        unsigned immediate; //immediate field
-        string label; //for conditional branches, label of the target instruction - used only for parsing/debugging purposes
-} instruction_t;
 
 // execution unit
 typedef struct{
 	exe_unit_t type;  // execution unit type
 	unsigned latency; // execution unit latency
-	unsigned busy;    // 0 if execution unit is free, otherwise number of clock cycles during
-                          // which the execution unit will be busy. It should be initialized
-			  // to the latency of the unit when the unit becomes busy, and decremented
-			  // at each clock cycle
-	instruction_t instruction; // instruction using the functional unit
+	unsigned initiation_interval; // clock cycles between the start of two instructions on the unit (equal to latency if the unit is not pipelined)
+	unsigned ready_cycle; // clock cycle from which the execution unit is free: the unit is busy as long as clock_cycles < ready_cycle
+	                      // It is set to clock_cycles + initiation_interval when the unit starts executing an instruction (see start_unit),
+	                      // so that busy units do not need to be updated at each clock cycle
+	instruction_t instruction; // last instruction started on the functional unit
+	vector<unsigned> completions; // completion cycles of the instructions in flight on the unit, oldest first (circular buffer of latency/initiation_interval entries, rounded up)
+	unsigned oldest_completion; // entry of "completions" holding the oldest instruction in flight
+	unsigned in_flight; // number of instructions in flight (some of them may have completed, see retire_unit)
 } unit_t;
 
+// instruction in the EXE stage of the in-order pipeline (see run): it is started on an execution unit when it enters EXE,
+// and leaves EXE (to EX/MEM) once completed - one instruction per clock cycle, the oldest completed one first
+typedef struct{
+	instruction_t instruction;
+	unsigned pc; // address of the instruction
+	unsigned b; // B register, passed to EX/MEM (data of stores)
+	unsigned alu_output; // ALU_OUTPUT register
+	unsigned cond; // COND register (branches)
+	unsigned completion_cycle; // clock cycle at which the execution completes (see start_unit)
+} exe_instruction_t;
+
+/*
+Scoreboard (CDC 6600 style - see init_scoreboard): instructions are issued in order to a free execution unit, and
+then read their operands, execute and write their result out of order. Each execution unit holds one instruction
+from issue to write result (the initiation interval of pipelined units is not used).
+- issue: stalls if no unit of the required type is free (structural hazard), or if an active instruction is going
+  to write the same destination register (WAW hazard)
+- read operands: waits until no active instruction is going to write a source register (RAW hazard)
+- execute: takes the latency of the unit
+- write result: waits until no active instruction still has to read the destination register as a source (WAR hazard)
+In scoreboard mode, run() issues at most one instruction per clock cycle (see run_scoreboard). The data memory is accessed
+in program order: a load reads its operands (and the data memory) once the older stores have written their result, and a
+store writes the data memory once the older loads have read theirs and the older stores have written theirs. Branches stop
+the issue until they write their result, and EOP ends the simulation once all the units are free.
+Registers are numbered 0 ... NUM_GP_REGISTERS-1 (integer) and NUM_GP_REGISTERS ... SCOREBOARD_REGISTERS-1 (floating point).
+*/
+#define SCOREBOARD_REGISTERS (2*NUM_GP_REGISTERS)
+
+typedef enum {STRUCTURAL_HAZARD, RAW_HAZARD, WAR_HAZARD, WAW_HAZARD} hazard_t;
+
+#define NUM_HAZARD_TYPES 4
+
+// scoreboard status of an execution unit
+typedef struct{
+	bool busy; // the unit holds an instruction (from issue to write result)
+	unsigned dest; // destination register (Fi - UNDEFINED if none)
+	unsigned src[2]; // source registers (Fj, Fk - UNDEFINED if none)
+	unsigned producer[2]; // units which are going to write the source registers (Qj, Qk - UNDEFINED if none)
+	bool ready[2]; // source registers ready and not yet read (Rj, Rk)
+	unsigned completion_cycle; // clock cycle at which the execution completes (UNDEFINED until the operands are read)
+	unsigned pc; // address of the instruction
+	unsigned issue_cycle; // clock cycle in which the instruction was issued (program order)
+	unsigned result; // result, computed when the operands are read (data for stores, COND for branches)
+	unsigned address; // data memory address of loads and stores, target of branches
+} scoreboard_entry_t;
+
+/*
+Tomasulo engine (see init_tomasulo): replaces the in-order pipeline of run() with dynamic scheduling.
+- issue: one instruction per clock cycle, in program order, takes a reservation station of the type of execution unit
+  it needs and a reorder buffer (ROB) entry, whose index is its tag; its source registers are renamed to the tags of
+  their producers, and the values already available are read from the register file or the ROB
+- execute: the instructions whose operands are available start on a free execution unit of their type, oldest first;
+  loads and stores issue their data memory access (data_memory_issue) with the address computation, loads once all
+  the older stores have committed (the data memory itself is written by the stores when they commit)
+- write result: up to "cdb_width" completed instructions per clock cycle, oldest first, broadcast their result on the
+  common data bus (CDB) to the reservation stations and the ROB, and free their reservation station
+- commit: up to "commit_width" instructions per clock cycle leave the head of the ROB in program order, and update the
+  register file (stores write the data memory)
+Branches are predicted not taken (jumps are followed at issue): a taken branch flushes the younger instructions when
+it commits, and the fetch restarts from its target. Registers are numbered as in the scoreboard.
+*/
+
+// reservation station
+typedef struct{
+	bool busy; // the station holds an instruction (from issue to write result)
+	unsigned rob; // ROB entry (tag) of the instruction
+	unsigned value[2]; // source operands (Vj, Vk)
+	unsigned tag[2]; // ROB entries producing the source operands (Qj, Qk - UNDEFINED if available)
+	unsigned result; // result of the instruction, computed when it starts executing
+	unsigned completion_cycle; // clock cycle at which the execution completes (UNDEFINED until it starts)
+	bool cdb_stalled; // the completed instruction has had to wait for the CDB (counted once in the statistics)
+} reservation_station_t;
+
+// reorder buffer entry
+typedef struct{
+	instruction_t instruction;
+	unsigned pc;
+	unsigned station; // reservation station of the instruction (UNDEFINED once its result is written, or if it does not need one)
+	unsigned dest; // destination register (UNDEFINED if none)
+	bool ready; // result written (the instruction can commit)
+	unsigned value; // result (data for stores)
+	unsigned address; // data memory address of loads and stores, target of branches
+	bool taken; // taken branch
+} rob_entry_t;
+
+// statistics of the Tomasulo engine
+typedef struct{
+	unsigned rob_full; // clock cycles in which the issue stalled because the ROB was full
+	unsigned stations_full; // clock cycles in which the issue stalled because no reservation station was free
+	unsigned cdb_stalls; // completed instructions which had to wait for the CDB
+	unsigned flushes; // taken branches which flushed the younger instructions
+} tomasulo_stats_t;
+
+class sim_pipe_fp_checkpoint;
+
 class sim_pipe_fp{
 
-        //instruction memory 
-        instruction_t instr_memory[PROGRAM_SIZE];
+	friend class sim_pipe_fp_checkpoint;
+
+        //program in instruction memory - read-only, possibly shared with other simulator instances
+        shared_ptr<const program_t> program;
+
+        //instruction memory (instructions of the program, indexed by (PC-instr_base_address)>>2)
+        const instruction_t *instr_memory;
+        unsigned instr_memory_size;
 
         //base address in the instruction memory where the program is loaded
         unsigned instr_base_address;
-
-	//data memory - should be initialize to all 0xFF
-	unsigned char *data_memory;
+	//data memory - sparse: pages are allocated on first write, locations never written read as 0xFF
+	paged_memory data_memory;
 
 	//memory size in bytes
 	unsigned data_memory_size;
@@ -72,9 +178,61 @@ class sim_pipe_fp{
 	//memory latency in clock cycles
 	unsigned data_memory_latency;
 
-	//execution units
-	unit_t exec_units[MAX_UNITS];
-	unsigned num_units;
+	//data caches and DRAM (timing only) - by default, every data memory access takes data_memory_latency clock cycles
+	memory_hierarchy data_memory_hierarchy;
+
+	//execution units, grouped by type: the units of type t are exec_units[unit_begin[t]] ... exec_units[unit_begin[t+1]-1]
+	vector<unit_t> exec_units;
+	unsigned unit_begin[NUM_UNIT_TYPES+1];
+
+	//for each type of execution unit, min-heap of its units ordered by ready cycle (the root is the unit which is free first)
+	//the heap of type t occupies the same entries as its units (unit_heap[unit_begin[t]] is its root)
+	vector<unsigned> unit_heap;
+	vector<unsigned> unit_heap_position; //position of each unit in unit_heap
+
+	//structural stalls, for each type of execution unit, and last clock cycle in which one was counted (at most one per clock cycle, see get_free_unit)
+	unsigned structural_stalls[NUM_UNIT_TYPES];
+	unsigned last_structural_stall[NUM_UNIT_TYPES];
+
+	//scoreboard (see init_scoreboard): status of each execution unit, and unit going to write each register (UNDEFINED if none)
+	bool scoreboarding;
+	vector<scoreboard_entry_t> scoreboard;
+	unsigned register_producer[SCOREBOARD_REGISTERS];
+	unsigned scoreboard_pc; //PC of the next instruction to be issued
+	bool scoreboard_fetch_stopped; //a branch has been issued: no further instruction is issued until it writes its result
+
+	//stall cycles of the scoreboard, for each type of hazard, and last clock cycle in which one was counted (at most one per clock cycle)
+	unsigned hazard_stalls[NUM_HAZARD_TYPES];
+	unsigned last_hazard_stall[NUM_HAZARD_TYPES];
+
+	//Tomasulo engine (see init_tomasulo)
+	bool tomasulo;
+	unsigned cdb_width;
+	unsigned commit_width;
+	vector<reservation_station_t> stations; //reservation stations, grouped by type as the execution units
+	unsigned station_begin[NUM_UNIT_TYPES+1];
+	vector<rob_entry_t> rob; //reorder buffer, managed as a circular FIFO
+	unsigned rob_head; //oldest instruction
+	unsigned rob_count; //number of instructions in the ROB
+	unsigned register_tag[SCOREBOARD_REGISTERS]; //ROB entry going to write each register (UNDEFINED if none)
+	unsigned architectural_registers[SCOREBOARD_REGISTERS]; //register file updated at commit (floating point registers in their binary representation)
+	unsigned tomasulo_pc; //PC of the next instruction to be issued
+	bool tomasulo_fetch_stopped; //EOP issued: no further instruction is fetched (unless a flush restarts the fetch)
+	bool tomasulo_done; //EOP committed
+	tomasulo_stats_t tomasulo_stats;
+
+	//functional execution (see run_functional)
+	unsigned functional_pc; //PC of the next instruction to be executed functionally, or by run() when it starts
+	unsigned functional_instructions; //number of instructions executed functionally
+	unsigned roi_end_pc; //end of the region of interest while it is simulated in detail (UNDEFINED otherwise) - see run_roi
+	bool roi_end_fetched; //the last EOP fetched is the one at roi_end_pc, i.e., run() has stopped at the end of the region of interest
+
+	//idle clock cycles simulated at once (see init_cycle_skipping)
+	bool cycle_skipping;
+	unsigned skipped_cycles;
+
+	//forwarding network and its statistics (see init_forwarding)
+	forwarding_network forwarding;
 
        //statistics
         unsigned clock_cycles;
@@ -82,12 +240,25 @@ class sim_pipe_fp{
         unsigned instructions_executed;
 
         /* registers */
-        // <TODO: add (integer and floating point) general purpose registers here>
-        // <TODO: add pipeline registers (other than IR) here>
+        unsigned int_registers[NUM_GP_REGISTERS]; //integer general purpose registers (UNDEFINED until written)
+        float fp_registers[NUM_GP_REGISTERS]; //floating point general purpose registers (UNDEFINED until written)
+
+        // pipeline registers: sp_registers[s] holds the special purpose registers at the entrance of stage s
+        // (PC in sp_registers[IF]; UNDEFINED if not used by the instruction)
+        unsigned sp_registers[NUM_STAGES][NUM_SP_REGISTERS];
 
         // IR is stored using the instruction_t data type
         instruction_t ir[NUM_STAGES-1];
 
+        // address of the instruction in each IR (UNDEFINED for bubbles) - not a special purpose register, used by the prefetcher
+        unsigned ir_pc[NUM_STAGES-1];
+
+        // instructions in the EXE stage, in program order (see exe_instruction_t)
+        vector<exe_instruction_t> exe_instructions;
+
+        // clock cycle at which the data memory access of the instruction in MEM completes (UNDEFINED until it has been issued)
+        unsigned memory_ready_cycle;
+
 public:
 
 	//instantiates the simulator with a data memory of given size (in bytes) and latency (in clock cycles)
@@ -100,13 +271,51 @@ public:
         // - exec_unit: type of execution unit to be added
         // - latency: latency of the execution unit (in clock cycles)
         // - instances: number of execution units of this type to be added
-        void init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances=1);
+        // - initiation_interval: for pipelined units, clock cycles after which the unit can start a new instruction (0: not pipelined, i.e., equal to the latency)
+        // exits with an error if the unit type is not valid, if no instance is requested, if the initiation interval exceeds the latency, or if the simulation has already started
+        void init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances=1, unsigned initiation_interval=0);
 
 	//loads the assembly program in file "filename" in instruction memory at the specified address
 	void load_program(const char *filename, unsigned base_address=0x0);
 
+	//loads the binary program image in file "filename" (see save_binary) in instruction memory at the specified address
+	void load_binary(const char *filename, unsigned base_address=0x0);
+
+	//saves the program currently in instruction memory as a binary program image in file "filename"
+	void save_binary(const char *filename);
+
+	//parses the assembly program in file "filename" - the program returned can be attached to any number of simulator instances
+	static shared_ptr<const program_t> read_program(const char *filename);
+
+	//reads the binary program image in file "filename" - the program returned can be attached to any number of simulator instances
+	static shared_ptr<const program_t> read_binary(const char *filename);
+
+	//attaches an already loaded program to instruction memory at the specified address (the program is shared, not copied)
+	void attach_program(shared_ptr<const program_t> program, unsigned base_address=0x0);
+
+	//returns the program currently in instruction memory (NULL if no program is loaded)
+	shared_ptr<const program_t> get_program();
+
 	//runs the simulator for "cycles" clock cycles (run the program to completion if cycles=0) 
 	void run(unsigned cycles=0);
+
+	//executes "instructions" instructions functionally (up to EOP if instructions=0): architecturally, without modeling the pipeline
+	//- the execution starts from the beginning of the program, or where the previous functional execution stopped, and stops before EOP
+	//- registers are accessed through get_int_register/set_int_register and get_fp_register/set_fp_register, data memory through read_memory/write_memory
+	//- clock cycles and statistics are not updated: run() then simulates the rest of the program in detail, starting from get_functional_pc()
+	//returns the number of instructions executed
+	unsigned run_functional(unsigned instructions=0);
+
+	//runs the program, simulating in detail only its region of interest (marked by the .roi_begin and .roi_end directives):
+	//- the program is executed functionally up to .roi_begin (see run_functional)
+	//- the region is simulated in detail with run(), to which .roi_end looks like the end of the program (EOP)
+	//- the rest of the program is executed functionally
+	//as a result, the statistics (clock cycles, stalls, instructions executed, IPC) only cover the region of interest
+	//a missing .roi_begin (.roi_end) directive stands for the beginning (end) of the program
+	void run_roi();
+
+	//returns the PC of the next instruction to be executed after run_functional (the beginning of the program if run_functional has not been invoked)
+	unsigned get_functional_pc();
 	
 	//resets the state of the simulator
         /* Note: 
@@ -146,32 +355,240 @@ public:
 	//returns the number of instructions fully executed
 	unsigned get_instructions_executed();
 
+	//returns the number of instructions executed functionally (see run_functional)
+	unsigned get_functional_instructions();
+
 	//returns the number of clock cycles 
 	unsigned get_clock_cycles();
 
 	//returns the number of stalls added by processor
 	unsigned get_stalls();
 
+	//returns the number of clock cycles (included in get_clock_cycles) which have been skipped as idle (see init_cycle_skipping)
+	unsigned get_skipped_cycles();
+
+	//returns the number of hits, misses and evictions in the given data cache level
+	unsigned get_cache_hits(cache_level_t level);
+	unsigned get_cache_misses(cache_level_t level);
+	unsigned get_cache_evictions(cache_level_t level);
+
+	//returns the memory-level parallelism (average number of outstanding L1 misses, when at least one is outstanding)
+	float get_memory_level_parallelism();
+
+	//returns the number of L1 misses merged into an outstanding miss to the same line
+	unsigned get_merged_misses();
+
+	//returns the number of data memory accesses which could not be issued because all the MSHRs were busy
+	unsigned get_mshr_full_stalls();
+
+	//returns the number of clock cycles in which an instruction could not start execution because all the units of the given type were busy (structural hazard)
+	unsigned get_structural_stalls(exe_unit_t type);
+
+	//returns the number of clock cycles in which the scoreboard stalled an instruction because of the given type of hazard
+	unsigned get_hazard_stalls(hazard_t hazard);
+
+	//returns the statistics of the Tomasulo engine: clock cycles in which the issue stalled because the ROB or the reservation stations were full,
+	//results delayed by the common data bus, and flushes caused by taken branches
+	unsigned get_rob_full_stalls();
+	unsigned get_reservation_station_stalls();
+	unsigned get_cdb_stalls();
+	unsigned get_branch_flushes();
+
+	//returns the number of DRAM row hits, row misses (bank without an open row) and row conflicts (another row open)
+	unsigned get_dram_row_hits();
+	unsigned get_dram_row_misses();
+	unsigned get_dram_row_conflicts();
+
+	//returns the accuracy (useful/issued prefetches), coverage (fraction of L1 misses removed) and timeliness (fraction of useful prefetches not late) of the prefetcher
+	float get_prefetch_accuracy();
+	float get_prefetch_coverage();
+	float get_prefetch_timeliness();
+
+	//returns the number of loads forwarded from the store buffer, and the number of stores stalled because the store buffer was full
+	unsigned get_forwarded_loads();
+	unsigned get_store_buffer_full_stalls();
+
+	//returns the number of operands forwarded through the given path, and the number of RAW stalls that path removed (see init_forwarding)
+	unsigned get_forwarded_operands(forwarding_path_t path);
+	unsigned get_forwarding_saved_stalls(forwarding_path_t path);
+
 	//prints the content of the data memory within the specified address range
 	void print_memory(unsigned start_address, unsigned end_address);
 
 	// writes an integer value to data memory at the specified address (use little-endian format: https://en.wikipedia.org/wiki/Endianness)
 	void write_memory(unsigned address, unsigned value);
 
+	// reads an integer value from data memory at the specified address (little-endian format)
+	unsigned read_memory(unsigned address);
+
+	// writes "size" bytes from "data" to data memory, starting at the specified address
+	void write_memory_block(unsigned address, const unsigned char *data, unsigned size);
+
+	// loads the memory image in file "filename" (raw binary or sectioned image, see paged_memory.h) in data memory at the specified address
+	void load_memory_image(const char *filename, unsigned base_address=0x0);
+
+	// adds a data cache level in front of data memory
+	// - level: CACHE_L1 or CACHE_L2 (an L2 cache requires an L1 cache)
+	// - size, line_size: in bytes (powers of 2)
+	// - associativity: number of ways (size/line_size for a fully associative cache)
+	// - hit_latency: in clock cycles
+	void init_cache(cache_level_t level, unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency, replacement_policy_t replacement=REPL_LRU, write_policy_t write_policy=WRITE_BACK);
+
+	// makes the L1 data cache non-blocking, with "num_mshrs" miss status holding registers (0: blocking cache, the default)
+	// independent misses can then overlap their latency (see data_memory_issue) in the Tomasulo engine - the in-order pipeline
+	// stalls in MEM until each access completes
+	void init_mshrs(unsigned num_mshrs);
+
+	// replaces the fixed data memory latency with a DRAM model (see dram.h)
+	// - num_banks: number of banks (power of 2)
+	// - row_size: size of a row in bytes (power of 2)
+	// - row_hit_latency, row_miss_latency, row_conflict_latency: in clock cycles
+	void init_dram(unsigned num_banks, unsigned row_size, unsigned row_hit_latency, unsigned row_miss_latency, unsigned row_conflict_latency);
+
+	// adds a stride prefetcher (with next-line fallback) to the L1 data cache (see prefetcher.h)
+	// - table_size: number of entries of the stride table, indexed by the PC of the loads (power of 2)
+	// - degree: number of lines prefetched at each trigger
+	// prefetchers are trained by the loads issued through data_memory_issue
+	void init_prefetcher(unsigned table_size, unsigned degree=1);
+
+	// adds a store buffer with "num_entries" entries in front of the data caches (see memory_hierarchy.h)
+	// stores issued through data_memory_issue then complete without waiting for the memory latency,
+	// and loads to the address of a buffered store get its value forwarded
+	void init_store_buffer(unsigned num_entries);
+
+	// sets the forwarding network (NO_FORWARDING by default - see forwarding.h)
+	// the configuration is preserved by reset()
+	void init_forwarding(forwarding_t forwarding);
+
+	// enables (the default) or disables the skipping of idle clock cycles in the in-order pipeline: when no instruction can move
+	// until an execution unit or a data memory access completes, the clock cycles until then are simulated at once
+	// - the statistics are the same either way; the configuration is preserved by reset()
+	void init_cycle_skipping(bool enabled);
+
+	// switches the floating point pipeline to scoreboard mode (see scoreboard_entry_t), in which independent instructions
+	// can proceed past long-latency ones - the configuration is preserved by reset()
+	void init_scoreboard();
+
+	// replaces the in-order pipeline of run() with the Tomasulo engine (see reservation_station_t), with a reorder buffer
+	// of "rob_size" entries, a common data bus which carries "cdb_width" results per clock cycle, and "commit_width" instructions
+	// committed per clock cycle
+	// - the reservation stations of each type of execution unit are added with init_reservation_stations
+	// - exits with an error if the configuration is not valid, or if the simulation has already started
+	void init_tomasulo(unsigned rob_size, unsigned cdb_width=1, unsigned commit_width=1);
+
+	// adds "num_stations" reservation stations for the execution units of the given type (Tomasulo engine)
+	void init_reservation_stations(exe_unit_t type, unsigned num_stations);
+
 	//prints the values of the registers 
 	void print_registers();
 
+	//saves the full state of the simulator: registers, pipeline registers (including IR), execution units, statistics and data memory
+	//data memory pages are shared copy-on-write between the simulator and the checkpoint, so that taking a checkpoint is cheap
+	sim_pipe_fp_checkpoint *save_checkpoint();
+
+	//restores the state saved in "checkpoint" - the same checkpoint can be restored any number of times
+	void restore_checkpoint(const sim_pipe_fp_checkpoint *checkpoint);
+
 private:
 
-	// returns a free exec unit for the particular instruction type
+	//the simulator state is copied only through checkpoints
+	sim_pipe_fp(const sim_pipe_fp &) = default;
+	sim_pipe_fp &operator=(const sim_pipe_fp &) = default;
+
+	// returns a free exec unit for the particular instruction type (in O(1): the unit which is free first)
+	// if all of them are busy, returns UNDEFINED and counts a structural stall (at most one per clock cycle and unit type)
 	unsigned get_free_unit(opcode_t opcode);	
-	
-	//reduces execution unit busy time (to be invoked at every clock cycle 
-	void decrement_units_busy_time();
+
+	// starts executing "instruction" on unit "unit", which stays busy for its initiation interval (i.e., until clock_cycles + initiation_interval)
+	// returns the clock cycle at which the instruction completes (clock_cycles + latency)
+	unsigned start_unit(unsigned unit, const instruction_t &instruction);
+
+	// returns the number of clock cycles during which unit "unit" is still busy, i.e., cannot start a new instruction (0 if free)
+	unsigned unit_busy_time(unsigned unit);
+
+	// removes from unit "unit" the instructions in flight which have completed by the current clock cycle
+	void retire_unit(unsigned unit);
+
+	// moves unit "unit" towards the leaves of the heap of its type, after its ready cycle has increased
+	void sift_unit_down(unsigned unit);
 
 	//debug units
 	void debug_units();
 
+	// scoreboard stages (see init_scoreboard) - each returns false, and counts a stall of the corresponding hazard type, if the instruction cannot proceed in this clock cycle
+	// issue: "instruction", fetched at "pc", is assigned to a free execution unit, returned in "unit"
+	bool scoreboard_issue(const instruction_t &instruction, unsigned pc, unsigned &unit);
+
+	// read operands: the instruction in unit "unit" reads its operands (loads also the data memory) and starts executing
+	// (it also waits, without counting a stall, if its data memory access cannot be issued)
+	bool scoreboard_read_operands(unsigned unit);
+
+	// returns true if the instruction in unit "unit" has completed its execution
+	bool scoreboard_execution_complete(unsigned unit);
+
+	// write result: the instruction in unit "unit" writes its result (stores write the data memory), and frees the unit
+	bool scoreboard_write_result(unsigned unit);
+
+	// runs the scoreboard for "cycles" clock cycles (to completion if cycles=0) - invoked by run() in scoreboard mode
+	void run_scoreboard(unsigned cycles);
+
+	// counts a stall cycle of the scoreboard caused by hazard "hazard" (at most one per clock cycle and hazard type)
+	void count_hazard_stall(hazard_t hazard);
+
+	// moves unit "unit" towards the root of the heap of its type, after its ready cycle has decreased
+	void sift_unit_up(unsigned unit);
+
+	// returns the instruction stored at address "pc" in instruction memory (a NOP if "pc" is outside the loaded program)
+	// (EOP at the end of the region of interest, while it is simulated in detail by run_roi)
+	const instruction_t &fetch_instruction(unsigned pc);
+
+	// returns the number of clock cycles taken by a data memory access to the specified address (through the data caches, if any)
+	unsigned data_memory_access_latency(unsigned address, bool is_write);
+
+	// issues a data memory access to the specified address in the current clock cycle, by the instruction at "pc" (non-blocking caches, see init_mshrs)
+	// returns the clock cycle at which the access completes, or UNDEFINED if all the MSHRs are busy or the store buffer is full (the access has to be retried)
+	unsigned data_memory_issue(unsigned address, bool is_write, unsigned pc=UNDEFINED);
+
+	// returns the value of register "reg" (numbered as by destination_register) for the instruction entering EXE with forwarding enabled
+	// ("value", read in ID, if reg is UNDEFINED) - to be invoked in the EXE stage, once MEM and WB have been processed
+	unsigned forwarded_operand(unsigned reg, unsigned value);
+
+	// skips "n" idle clock cycles, i.e., clock cycles in which the pipeline is stalled and nothing changes but the cycle count:
+	// clock cycles and stalls are increased by n (busy execution units become free on their own, see unit_t), and so are the
+	// structural stalls counted in the last simulated clock cycle, which the skipped ones repeat
+	// n is capped to the clock cycles left in the current run(cycles) invocation (given its "cycles" and "start_cycles"), so that the run budget is respected
+	void skip_idle_cycles(unsigned n, unsigned cycles, unsigned start_cycles);
+
+	// returns the number of upcoming clock cycles during which all the busy execution units stay busy, and no instruction in flight on a unit completes (UNDEFINED if no unit is busy)
+	// - to be invoked in the bookkeeping code, after clock_cycles has been increased
+	unsigned idle_unit_cycles();
+
+	// executes instructions functionally (see run_functional), stopping after "instructions" instructions (if not 0), before EOP, or before "stop_pc"
+	unsigned execute_functional(unsigned instructions, unsigned stop_pc);
+
+	// runs the Tomasulo engine for "cycles" clock cycles (to completion if cycles=0) - invoked by run() when configured
+	void run_tomasulo(unsigned cycles);
+
+	// stages of the Tomasulo engine (see reservation_station_t), for the current clock cycle - commit returns true once EOP has been committed
+	bool tomasulo_commit();
+	void tomasulo_execute();
+	void tomasulo_write_result();
+	void tomasulo_issue();
+
+	// empties the ROB and the reservation stations (after a taken branch, or at reset)
+	void tomasulo_flush();
+
+};
+
+// checkpoint of the state of a simulator (see sim_pipe_fp::save_checkpoint) - to be de-allocated with delete
+class sim_pipe_fp_checkpoint{
+
+	friend class sim_pipe_fp;
+
+	//saved state
+	sim_pipe_fp state;
+
+	sim_pipe_fp_checkpoint(const sim_pipe_fp &simulator) : state(simulator) {}
 };
 
 #endif /*SIM_PIPE_FP_H_*/
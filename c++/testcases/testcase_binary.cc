@@ -0,0 +1,151 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstddef>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+/* Test case for the binary program images (save_binary, load_binary) */
+/* asm/code.asm (loop) is saved as a binary image and run again from it: the symbol table, the region of interest and the
+   final registers, data memory and statistics are the same as when running it from the assembly. Images corrupted in
+   the header, in the instructions (including their registers) or in the symbol table are then rejected by load_binary. */
+
+#define IMAGE "bin/testcase_binary.bin"
+#define CORRUPTED_IMAGE "bin/testcase_binary_corrupted.bin"
+
+/* runs asm/code.asm (initialized as in testcase6), loaded from the assembly or from its binary image, and prints the final registers, data memory and statistics */
+void run_program(bool binary){
+	unsigned i, j;
+
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+	if (binary) mips->load_binary(IMAGE, 0x10000000);
+	else mips->load_program("asm/code.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	mips->run();
+
+	mips->print_registers();
+	mips->print_memory(0xA020, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+	cout << endl;
+	delete mips;
+}
+
+/* prints the symbol table and the region of interest of a program */
+void print_program(shared_ptr<const program_t> program){
+	cout << "Instructions = " << dec << program->num_instructions << endl;
+	for (map<string, unsigned, less<> >::const_iterator it = program->symbols.begin(); it != program->symbols.end(); it++)
+		cout << "Symbol " << it->first << " = " << dec << it->second << endl;
+	cout << "Region of interest = " << dec << program->roi_begin << " - " << program->roi_end << endl;
+}
+
+/* loads the image (in a child process, since an invalid image terminates the simulator), and prints whether it has been accepted */
+void check_image(const char *description, const vector<char> &image){
+	ofstream fout(CORRUPTED_IMAGE, ios::binary);
+	fout.write(image.data(), image.size());
+	fout.close();
+
+	cout << description << ": " << flush;
+	pid_t pid = fork();
+	if (pid == 0){
+		sim_pipe *mips = new sim_pipe(1024*1024, 0);
+		mips->load_binary(CORRUPTED_IMAGE, 0x10000000);
+		delete mips;
+		exit(0);
+	}
+	int status;
+	waitpid(pid, &status, 0);
+	cout << ((WIFEXITED(status) && WEXITSTATUS(status) == 0) ? "accepted" : "rejected") << endl;
+}
+
+int main(int argc, char **argv){
+
+	cout << "ASSEMBLY" << endl;
+	run_program(false);
+
+	// round trip: the image saved is the same program
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+	mips->load_program("asm/code.asm", 0x10000000);
+	mips->save_binary(IMAGE);
+	delete mips;
+
+	cout << "BINARY IMAGE" << endl;
+	run_program(true);
+
+	cout << "asm/roi.asm" << endl;
+	mips = new sim_pipe(1024*1024, 0);
+	mips->load_program("asm/roi.asm", 0x10000000);
+	print_program(mips->get_program());
+	mips->save_binary(IMAGE);
+	delete mips;
+	cout << "BINARY IMAGE" << endl;
+	print_program(sim_pipe::read_binary(IMAGE));
+	cout << endl;
+
+	// corrupted images, derived from the valid image of asm/roi.asm
+	ifstream fin(IMAGE, ios::binary);
+	vector<char> image((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+	fin.close();
+	program_image_header_t header = *(const program_image_header_t *) image.data();
+	size_t instructions = sizeof(program_image_header_t);
+	size_t symbols = instructions + header.num_instructions * sizeof(instruction_t);
+	shared_ptr<const program_t> program = sim_pipe::read_binary(IMAGE);
+	unsigned branch = 0;
+	while (!(program->instructions[branch].flags & CLASS_BRANCH)) branch++;
+	vector<char> corrupted;
+
+	check_image("Valid image", image);
+
+	corrupted = image;
+	((program_image_header_t *) corrupted.data())->version = PROGRAM_IMAGE_VERSION + 1;
+	check_image("Wrong version", corrupted);
+
+	corrupted = image;
+	corrupted.pop_back();
+	check_image("Truncated image", corrupted);
+
+	corrupted = image;
+	((instruction_t *) (corrupted.data() + instructions))[0].flags |= CLASS_FP;
+	check_image("Wrong flags", corrupted);
+
+	corrupted = image;
+	((instruction_t *) (corrupted.data() + instructions))[0].opcode = ADDS;
+	check_image("Floating point opcode", corrupted);
+
+	corrupted = image;
+	((instruction_t *) (corrupted.data() + instructions))[0].src1 = NUM_GP_REGISTERS;
+	check_image("Register out of range", corrupted);
+
+	corrupted = image;
+	((instruction_t *) (corrupted.data() + instructions))[branch].target = header.num_instructions + 1;
+	check_image("Branch target out of range", corrupted);
+
+	corrupted = image;
+	((instruction_t *) (corrupted.data() + instructions))[branch].immediate += 4;
+	check_image("Branch offset not matching the target", corrupted);
+
+	corrupted = image;
+	((program_image_symbol_t *) (corrupted.data() + symbols))[0].index = header.num_instructions + 1;
+	check_image("Symbol index out of range", corrupted);
+
+	corrupted = image;
+	((program_image_symbol_t *) (corrupted.data() + symbols))[0].name = header.string_table_size;
+	check_image("Symbol name out of range", corrupted);
+
+	corrupted = image;
+	corrupted.back() = 'X';
+	check_image("Symbol name not terminated", corrupted);
+
+	corrupted = image;
+	((program_image_header_t *) corrupted.data())->roi_end = header.num_instructions + 1;
+	check_image("Region of interest out of range", corrupted);
+
+	remove(IMAGE);
+	remove(CORRUPTED_IMAGE);
+}
@@ -0,0 +1,55 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the branch predictor (init_branch_predictor) */
+/* asm/code.asm is a loop of 8 iterations, with a branch which is never taken and a loop branch which is taken 7 times:
+   without a predictor every branch stalls the fetch until it is resolved, while with a predictor only the mispredicted
+   branches lose a clock cycle (a bimodal predictor learns the loop branch, which a not-taken predictor always mispredicts;
+   with a BTB, the target of the loop branch is known at fetch only once the branch has been inserted in the BTB) */
+
+/* runs asm/code.asm with the given predictor (or none), and prints the final data memory and statistics */
+void run_program(bool predictor, predictor_t type, unsigned table_size, unsigned history_bits, unsigned btb_size){
+	unsigned i, j;
+
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+	if (predictor) mips->init_branch_predictor(type, table_size, history_bits, btb_size);
+
+	mips->load_program("asm/code.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	mips->run();
+
+	mips->print_memory(0xA020, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+	if (predictor){
+		cout << "Prediction accuracy = " << mips->get_branch_prediction_accuracy() << endl;
+		cout << "Mispredictions = " << dec << mips->get_branch_mispredictions() << endl;
+		cout << "Mispredict penalty = " << dec << mips->get_branch_mispredict_penalty() << endl;
+		cout << "BTB misses = " << dec << mips->get_btb_misses() << endl;
+	}
+	cout << endl;
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	cout << "NO BRANCH PREDICTOR" << endl;
+	run_program(false, PREDICT_NOT_TAKEN, 0, 0, 0);
+
+	cout << "PREDICT NOT TAKEN" << endl;
+	run_program(true, PREDICT_NOT_TAKEN, 0, 0, 0);
+
+	cout << "BIMODAL, 16 COUNTERS" << endl;
+	run_program(true, PREDICT_BIMODAL, 16, 0, 0);
+
+	cout << "GSHARE, 16 COUNTERS, 4 HISTORY BITS" << endl;
+	run_program(true, PREDICT_GSHARE, 16, 4, 0);
+
+	cout << "BIMODAL, 16 COUNTERS, 4-ENTRY BTB" << endl;
+	run_program(true, PREDICT_BIMODAL, 16, 0, 4);
+}
@@ -0,0 +1,61 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the data caches (init_cache) */
+/* asm/code.asm is run with a 10 clock cycles data memory, without caches, with a large L1 cache (compulsory misses only),
+   and with a small direct-mapped L1 cache backed by an L2 cache (conflict misses in L1, served by L2) */
+
+/* runs asm/code.asm on a freshly initialized data memory, and prints the final data memory and statistics */
+void run_program(sim_pipe *mips){
+	unsigned i, j;
+
+	mips->load_program("asm/code.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	mips->run();
+
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+}
+
+/* prints the statistics of a cache level */
+void print_cache_stats(sim_pipe *mips, cache_level_t level){
+	cout << (level == CACHE_L1 ? "L1" : "L2") << ": hits = " << dec << mips->get_cache_hits(level);
+	cout << ", misses = " << mips->get_cache_misses(level);
+	cout << ", evictions = " << mips->get_cache_evictions(level) << endl;
+}
+
+int main(int argc, char **argv){
+
+	sim_pipe *mips;
+
+	// no caches: every load and store takes the data memory latency
+	cout << "NO CACHES" << endl;
+	mips = new sim_pipe(1024*1024, 10);
+	run_program(mips);
+	delete mips;
+
+	// 1KB 2-way L1 cache with 16B lines: the array (0xA000-0xA027) and the output (0xB004-0xB023) fit in it
+	cout << endl << "L1: 1KB, 2-way, 16B lines, 1 clock cycle" << endl;
+	mips = new sim_pipe(1024*1024, 10);
+	mips->init_cache(CACHE_L1, 1024, 2, 16, 1);
+	run_program(mips);
+	print_cache_stats(mips, CACHE_L1);
+	delete mips;
+
+	// 32B direct-mapped L1 cache: the lines of the array and of the output map to the same two sets, and evict each other
+	cout << endl << "L1: 32B, direct-mapped, 16B lines, 1 clock cycle - L2: 256B, 4-way, 16B lines, 4 clock cycles" << endl;
+	mips = new sim_pipe(1024*1024, 10);
+	mips->init_cache(CACHE_L1, 32, 1, 16, 1);
+	mips->init_cache(CACHE_L2, 256, 4, 16, 4);
+	run_program(mips);
+	print_cache_stats(mips, CACHE_L1);
+	print_cache_stats(mips, CACHE_L2);
+	delete mips;
+}
@@ -0,0 +1,43 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the DRAM model (init_dram) */
+/* asm/code.asm alternates loads from the array at 0xA000 and stores to the output at 0xB000 (row hit: 5 clock cycles,
+   row miss: 10 clock cycles, row conflict: 20 clock cycles):
+   - with 4 banks and 256B rows, both regions map to bank 0 in different rows, and the accesses keep closing each other's row
+   - with 4 banks and 4KB rows, they map to banks 2 and 3, and after the first access to each bank all the accesses are row hits */
+
+/* runs asm/code.asm on a freshly initialized data memory, and prints the final data memory and statistics */
+void run_program(unsigned row_size){
+	unsigned i, j;
+
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+	mips->init_dram(4, row_size, 5, 10, 20);
+
+	mips->load_program("asm/code.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	mips->run();
+
+	mips->print_memory(0xA020, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "Row hits = " << dec << mips->get_dram_row_hits() << ", row misses = " << mips->get_dram_row_misses();
+	cout << ", row conflicts = " << mips->get_dram_row_conflicts() << endl;
+	cout << endl;
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	cout << "DRAM: 4 banks, 256B rows" << endl;
+	run_program(256);
+
+	cout << "DRAM: 4 banks, 4KB rows" << endl;
+	run_program(4096);
+}
@@ -0,0 +1,54 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the forwarding network (init_forwarding) */
+/* asm/data_dep1.asm (ALU -> ALU dependences), asm/data_dep2.asm (load -> ALU and ALU -> store dependences), asm/copy.asm
+   (load -> store dependences) and asm/same_operand.asm (both operands from the same producer, whose stalls are saved once)
+   are run at each forwarding level: the final registers and data memory are the same, while the stalls decrease as more
+   forwarding paths are enabled */
+
+/* prints the general purpose registers, as print_registers does */
+void print_gp_registers(sim_pipe *mips){
+	cout << "General purpose registers:" << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_gp_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << mips->get_gp_register(i) << hex << " / 0x" << mips->get_gp_register(i) << endl;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	const char *programs[4] = {"asm/data_dep1.asm", "asm/data_dep2.asm", "asm/copy.asm", "asm/same_operand.asm"};
+	const char *levels[4] = {"NO_FORWARDING", "FORWARD_EX_EX", "FORWARD_MEM_EX", "FULL_FORWARDING"};
+	const char *paths[NUM_FORWARDING_PATHS] = {"EX -> EX", "MEM -> EX", "MEM -> MEM"};
+
+	for (unsigned p=0; p<4; p++){
+		for (unsigned f=0; f<4; f++){
+			cout << programs[p] << ", " << levels[f] << endl;
+
+			// instantiates the simulator with a 1MB data memory
+			sim_pipe *mips = new sim_pipe(1024*1024, 0);
+			mips->init_forwarding((forwarding_t)f);
+
+			mips->load_program(programs[p], 0x10000000);
+			for (i=0; i<7; i++) mips->set_gp_register(i,i);
+			for (i = 0x0, j=10; i<0x20; i+=4, j+=10) mips->write_memory(i,j);
+			mips->run();
+
+			print_gp_registers(mips);
+			mips->print_memory(0x0, 0x2c);
+			cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+			cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+			cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+			for (unsigned path=0; path<NUM_FORWARDING_PATHS; path++){
+				cout << paths[path] << ": operands forwarded = " << dec << mips->get_forwarded_operands((forwarding_path_t)path);
+				cout << ", stalls saved = " << mips->get_forwarding_saved_stalls((forwarding_path_t)path) << endl;
+			}
+			cout << endl;
+			delete mips;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the data caches (init_cache) in the floating point pipeline and in the Tomasulo engine */
+/* asm/codefp.asm is run with a 9 clock cycles data memory, without caches and with a 1KB L1 cache (compulsory misses only) */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* instantiates the simulator with the execution units of testcase_fp0, possibly with the Tomasulo engine and an L1 cache */
+sim_pipe_fp *new_simulator(bool tomasulo, bool cache){
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 9);
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 7, 1);
+	mips->init_exec_unit(DIVIDER, 25, 1);
+	if (tomasulo){
+		mips->init_tomasulo(8);
+		mips->init_reservation_stations(INTEGER, 3);
+		mips->init_reservation_stations(ADDER, 2);
+		mips->init_reservation_stations(MULTIPLIER, 2);
+		mips->init_reservation_stations(DIVIDER, 1);
+	}
+	if (cache) mips->init_cache(CACHE_L1, 1024, 2, 16, 1);
+	return mips;
+}
+
+/* runs asm/codefp.asm on a freshly initialized data memory, and prints the final data memory and statistics */
+void run_program(sim_pipe_fp *mips, bool cache){
+	unsigned i, j;
+
+	mips->load_program("asm/codefp.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	mips->set_fp_register(1, 0.0);
+	mips->set_int_register(4, 1);
+	mips->run();
+
+	mips->print_memory(0xA020, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	if (cache) cout << "L1: hits = " << dec << mips->get_cache_hits(CACHE_L1) << ", misses = " << mips->get_cache_misses(CACHE_L1) << endl;
+	cout << endl;
+}
+
+int main(int argc, char **argv){
+
+	const char *engines[2] = {"IN-ORDER PIPELINE", "TOMASULO"};
+
+	for (unsigned t=0; t<2; t++){
+		for (unsigned c=0; c<2; c++){
+			cout << engines[t] << (c ? ", L1: 1KB, 2-way, 16B lines, 1 clock cycle" : ", NO CACHES") << endl;
+			sim_pipe_fp *mips = new_simulator(t, c);
+			run_program(mips, c);
+			delete mips;
+		}
+	}
+}
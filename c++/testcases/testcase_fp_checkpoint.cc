@@ -0,0 +1,112 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the checkpoints (save_checkpoint, restore_checkpoint) */
+/* asm/codefp.asm (loop) is run on the in-order pipeline with an L1 cache and on the Tomasulo engine. A checkpoint is
+   taken in the middle of the execution, with instructions in flight: the registers and data memory written after it
+   are restored, and running again from it (twice) gives the same final state and statistics as running the program
+   without interruption. */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* prints the integer and floating point registers, as print_registers does */
+void print_gp_registers(sim_pipe_fp *mips){
+	cout << "General purpose registers:" << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_int_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << mips->get_int_register(i) << hex << " / 0x" << mips->get_int_register(i) << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_fp_register(i)!=UNDEFINED) cout << "F" << dec << i << " = " << mips->get_fp_register(i) << hex << " / 0x" << float2unsigned(mips->get_fp_register(i)) << endl;
+}
+
+/* instantiates the simulator (configuration of testcase_fp_tomasulo), with an L1 cache or the Tomasulo engine, and loads asm/codefp.asm */
+sim_pipe_fp *new_simulator(bool tomasulo){
+	unsigned i, j;
+
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+	mips->init_exec_unit(INTEGER, 0, 2);
+	mips->init_exec_unit(ADDER, 4, 2);
+	mips->init_exec_unit(MULTIPLIER, 9, 2);
+	mips->init_exec_unit(DIVIDER, 19, 2);
+	if (tomasulo){
+		mips->init_tomasulo(8);
+		mips->init_reservation_stations(INTEGER, 4);
+		mips->init_reservation_stations(ADDER, 3);
+		mips->init_reservation_stations(MULTIPLIER, 2);
+		mips->init_reservation_stations(DIVIDER, 2);
+	} else {
+		mips->init_cache(CACHE_L1, 64, 2, 16, 1);
+	}
+
+	mips->load_program("asm/codefp.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+	mips->set_int_register(0,0);
+	mips->set_int_register(1,0xA000);
+	mips->set_int_register(4,1);
+	for (i=1; i<12; i++) mips->set_fp_register(i, (float)i);
+	return mips;
+}
+
+/* prints the final registers, data memory and statistics */
+void print_results(sim_pipe_fp *mips){
+	print_gp_registers(mips);
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+	cout << endl;
+}
+
+int main(int argc, char **argv){
+
+	const char *modes[2] = {"IN-ORDER, L1 CACHE", "TOMASULO"};
+
+	for (unsigned m=0; m<2; m++){
+		cout << modes[m] << endl << endl;
+
+		cout << "WITHOUT INTERRUPTION" << endl;
+		sim_pipe_fp *mips = new_simulator(m == 1);
+		mips->run();
+		print_results(mips);
+		delete mips;
+
+		cout << "CHECKPOINT AFTER 60 CLOCK CYCLES" << endl;
+		mips = new_simulator(m == 1);
+		mips->run(60);
+		sim_pipe_fp_checkpoint *checkpoint = mips->save_checkpoint();
+		cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl << endl;
+		mips->run();
+		print_results(mips);
+
+		// state modified after the checkpoint, and restored
+		mips->write_memory(0xA000, 0);
+		mips->set_fp_register(1, 0.0);
+		mips->restore_checkpoint(checkpoint);
+		cout << "RESTORED" << endl;
+		cout << "F1 = " << mips->get_fp_register(1) << endl;
+		mips->print_memory(0xA000, 0xA004);
+		cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+		cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl << endl;
+
+		cout << "RUN FROM THE CHECKPOINT" << endl;
+		mips->run();
+		print_results(mips);
+
+		cout << "RUN FROM THE CHECKPOINT AGAIN" << endl;
+		mips->restore_checkpoint(checkpoint);
+		mips->run();
+		print_results(mips);
+
+		delete checkpoint;
+		delete mips;
+	}
+}
@@ -0,0 +1,70 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the forwarding network (init_forwarding) in the floating point pipeline */
+/* asm/codefp0.asm (load -> floating point dependences) and asm/codefp.asm (loop with loads, stores and branches) are run
+   at each forwarding level: the final registers and data memory are the same, while the stalls decrease */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* prints the integer and floating point registers, as print_registers does */
+void print_gp_registers(sim_pipe_fp *mips){
+	cout << "General purpose registers:" << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_int_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << mips->get_int_register(i) << hex << " / 0x" << mips->get_int_register(i) << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_fp_register(i)!=UNDEFINED) cout << "F" << dec << i << " = " << mips->get_fp_register(i) << hex << " / 0x" << float2unsigned(mips->get_fp_register(i)) << endl;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	const char *programs[2] = {"asm/codefp0.asm", "asm/codefp.asm"};
+	const char *levels[4] = {"NO_FORWARDING", "FORWARD_EX_EX", "FORWARD_MEM_EX", "FULL_FORWARDING"};
+	const char *paths[NUM_FORWARDING_PATHS] = {"EX -> EX", "MEM -> EX", "MEM -> MEM"};
+
+	for (unsigned p=0; p<2; p++){
+		for (unsigned f=0; f<4; f++){
+			cout << programs[p] << ", " << levels[f] << endl;
+
+			// instantiates the simulator with the execution units of testcase_fp1-5
+			sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 0);
+			mips->init_exec_unit(INTEGER, 0, 1);
+			mips->init_exec_unit(ADDER, 4, 1);
+			mips->init_exec_unit(MULTIPLIER, 9, 1);
+			mips->init_exec_unit(DIVIDER, 19, 1);
+			mips->init_forwarding((forwarding_t)f);
+
+			mips->load_program(programs[p], 0x10000000);
+			for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+			mips->set_int_register(0,0);
+			mips->set_int_register(1,0xA000);
+			mips->set_int_register(4,1);
+			for (i=1; i<10; i++) mips->set_fp_register(i, (float)i);
+			mips->run();
+
+			print_gp_registers(mips);
+			mips->print_memory(0xA000, 0xA028);
+			mips->print_memory(0xB000, 0xB028);
+			cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+			cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+			cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+			for (unsigned path=0; path<NUM_FORWARDING_PATHS; path++){
+				cout << paths[path] << ": operands forwarded = " << dec << mips->get_forwarded_operands((forwarding_path_t)path);
+				cout << ", stalls saved = " << mips->get_forwarding_saved_stalls((forwarding_path_t)path) << endl;
+			}
+			cout << endl;
+			delete mips;
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the functional execution (run_functional) of the floating point pipeline */
+/* The final registers and data memory are the ones printed at the end of testcase_fp0, testcase_fp1 and testcase_fp5 */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* prints the integer and floating point registers, as print_registers does */
+void print_gp_registers(sim_pipe_fp *mips){
+	cout << "General purpose registers:" << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_int_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << mips->get_int_register(i) << hex << " / 0x" << mips->get_int_register(i) << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_fp_register(i)!=UNDEFINED) cout << "F" << dec << i << " = " << mips->get_fp_register(i) << hex << " / 0x" << float2unsigned(mips->get_fp_register(i)) << endl;
+}
+
+/* instantiates the simulator with the execution units of testcase_fp1-5 */
+sim_pipe_fp *new_simulator(){
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 0);
+	mips->init_exec_unit(INTEGER, 0, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 19, 1);
+	return mips;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+	sim_pipe_fp *mips;
+
+	// testcase_fp0 (loop)
+	cout << "asm/codefp.asm" << endl;
+	mips = new_simulator();
+	mips->load_program("asm/codefp.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	mips->set_fp_register(1, 0.0);
+	mips->set_int_register(4, 1);
+	cout << "Instructions executed functionally = " << dec << mips->run_functional() << endl;
+	print_gp_registers(mips);
+	mips->print_memory(0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl << endl;
+	delete mips;
+
+	// testcase_fp1 and testcase_fp5 (floating point dependences)
+	const char *programs[2] = {"asm/codefp0.asm", "asm/codefp3.asm"};
+	const unsigned fp_registers[2] = {10, 12};
+	for (unsigned p=0; p<2; p++){
+		cout << programs[p] << endl;
+		mips = new_simulator();
+		mips->load_program(programs[p], 0x10000000);
+		for (i = 0xA000, j=1; i<0xA010; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+		mips->set_int_register(0,0);
+		mips->set_int_register(1,0xA000);
+		for (i=0; i<fp_registers[p]; i++) mips->set_fp_register(i, (float)i);
+		cout << "Instructions executed functionally = " << dec << mips->run_functional() << endl;
+		print_gp_registers(mips);
+		mips->print_memory(0xA000, 0xA010);
+		cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl << endl;
+		delete mips;
+	}
+}
@@ -0,0 +1,68 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the scoreboard (init_scoreboard) */
+/* asm/codefp0.asm (RAW and WAW hazards), asm/codefp2.asm (WAR and WAW hazards), asm/codefp3.asm (long-latency divisions)
+   and asm/codefp.asm (loop with loads, stores and branches) are run on the in-order pipeline and in scoreboard mode: the final
+   registers and data memory are the same, while in scoreboard mode independent instructions proceed past the stalled ones */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* prints the integer and floating point registers, as print_registers does */
+void print_gp_registers(sim_pipe_fp *mips){
+	cout << "General purpose registers:" << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_int_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << mips->get_int_register(i) << hex << " / 0x" << mips->get_int_register(i) << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_fp_register(i)!=UNDEFINED) cout << "F" << dec << i << " = " << mips->get_fp_register(i) << hex << " / 0x" << float2unsigned(mips->get_fp_register(i)) << endl;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	const char *programs[4] = {"asm/codefp0.asm", "asm/codefp2.asm", "asm/codefp3.asm", "asm/codefp.asm"};
+	const char *hazards[NUM_HAZARD_TYPES] = {"Structural", "RAW", "WAR", "WAW"};
+
+	for (unsigned p=0; p<4; p++){
+		for (unsigned scoreboard=0; scoreboard<2; scoreboard++){
+			cout << programs[p] << ", " << (scoreboard ? "SCOREBOARD" : "IN-ORDER") << endl;
+
+			// instantiates the simulator with the execution units of testcase_fp1-5
+			sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+			mips->init_exec_unit(INTEGER, 0, 1);
+			mips->init_exec_unit(ADDER, 4, 1);
+			mips->init_exec_unit(MULTIPLIER, 9, 1);
+			mips->init_exec_unit(DIVIDER, 19, 1);
+			if (scoreboard) mips->init_scoreboard();
+
+			mips->load_program(programs[p], 0x10000000);
+			for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+			mips->set_int_register(0,0);
+			mips->set_int_register(1,0xA000);
+			mips->set_int_register(4,1);
+			for (i=1; i<12; i++) mips->set_fp_register(i, (float)i);
+			mips->run();
+
+			print_gp_registers(mips);
+			mips->print_memory(0xA000, 0xA028);
+			mips->print_memory(0xB000, 0xB028);
+			cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+			cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+			cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+			if (scoreboard)
+				for (unsigned h=0; h<NUM_HAZARD_TYPES; h++) cout << hazards[h] << " hazard stalls = " << dec << mips->get_hazard_stalls((hazard_t)h) << endl;
+			cout << endl;
+			delete mips;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+#include <vector>
+
+using namespace std;
+
+/* Test case for the skipping of idle clock cycles (init_cycle_skipping) in the floating point pipeline */
+/* asm/codefp.asm (10 clock cycles data memory, L1 data cache), asm/codefp3.asm (25 clock cycles divider) and asm/divs.asm
+   (independent divisions, stalled on the only divider) are run with the skipping disabled, enabled, and enabled with the
+   simulation advanced in steps of 5 clock cycles (the skipping stops at the end of each step): the final registers and
+   the values returned by all the statistics getters have to be the same, only the number of clock cycles skipped changes */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+typedef struct{
+	unsigned registers[2*NUM_GP_REGISTERS];
+	vector<unsigned> statistics; //values returned by the statistics getters (floats as their bit pattern), but get_skipped_cycles
+} stats_t;
+
+/* runs the program (in steps of "step" clock cycles, if not 0), and returns and prints the final statistics */
+stats_t run_program(const char *program, bool skipping, unsigned step){
+	unsigned i, j;
+
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 10);
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 4, 1);
+	mips->init_exec_unit(MULTIPLIER, 9, 1);
+	mips->init_exec_unit(DIVIDER, 25, 1);
+	mips->init_cache(CACHE_L1, 1024, 2, 16, 1);
+	mips->init_forwarding(FULL_FORWARDING);
+	mips->init_cycle_skipping(skipping);
+
+	mips->load_program(program, 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j/2));
+	mips->set_int_register(0,0);
+	mips->set_int_register(4,1);
+	for (i=0; i<12; i++) mips->set_fp_register(i, (float)i);
+	if (step == 0) mips->run();
+	else {
+		// run(step) returns early once the program has completed
+		unsigned start_cycles;
+		do {
+			start_cycles = mips->get_clock_cycles();
+			mips->run(step);
+		} while (mips->get_clock_cycles() - start_cycles == step);
+	}
+
+	stats_t stats;
+	for (i=0; i<NUM_GP_REGISTERS; i++){
+		stats.registers[i] = mips->get_int_register(i);
+		stats.registers[NUM_GP_REGISTERS+i] = float2unsigned(mips->get_fp_register(i));
+	}
+	stats.statistics.push_back(mips->get_instructions_executed());
+	stats.statistics.push_back(mips->get_functional_instructions());
+	stats.statistics.push_back(mips->get_clock_cycles());
+	stats.statistics.push_back(mips->get_stalls());
+	stats.statistics.push_back(float2unsigned(mips->get_IPC()));
+	for (unsigned l=CACHE_L1; l<=CACHE_L2; l++){
+		stats.statistics.push_back(mips->get_cache_hits((cache_level_t)l));
+		stats.statistics.push_back(mips->get_cache_misses((cache_level_t)l));
+		stats.statistics.push_back(mips->get_cache_evictions((cache_level_t)l));
+	}
+	stats.statistics.push_back(float2unsigned(mips->get_memory_level_parallelism()));
+	stats.statistics.push_back(mips->get_merged_misses());
+	stats.statistics.push_back(mips->get_mshr_full_stalls());
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++) stats.statistics.push_back(mips->get_structural_stalls((exe_unit_t)t));
+	for (unsigned h=0; h<NUM_HAZARD_TYPES; h++) stats.statistics.push_back(mips->get_hazard_stalls((hazard_t)h));
+	stats.statistics.push_back(mips->get_rob_full_stalls());
+	stats.statistics.push_back(mips->get_reservation_station_stalls());
+	stats.statistics.push_back(mips->get_cdb_stalls());
+	stats.statistics.push_back(mips->get_branch_flushes());
+	stats.statistics.push_back(mips->get_dram_row_hits());
+	stats.statistics.push_back(mips->get_dram_row_misses());
+	stats.statistics.push_back(mips->get_dram_row_conflicts());
+	stats.statistics.push_back(float2unsigned(mips->get_prefetch_accuracy()));
+	stats.statistics.push_back(float2unsigned(mips->get_prefetch_coverage()));
+	stats.statistics.push_back(float2unsigned(mips->get_prefetch_timeliness()));
+	stats.statistics.push_back(mips->get_forwarded_loads());
+	stats.statistics.push_back(mips->get_store_buffer_full_stalls());
+	for (unsigned f=PATH_EX_EX; f<=PATH_MEM_MEM; f++){
+		stats.statistics.push_back(mips->get_forwarded_operands((forwarding_path_t)f));
+		stats.statistics.push_back(mips->get_forwarding_saved_stalls((forwarding_path_t)f));
+	}
+
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+	cout << "L1 hits/misses = " << dec << mips->get_cache_hits(CACHE_L1) << "/" << mips->get_cache_misses(CACHE_L1) << endl;
+	cout << "Structural stalls (divider) = " << dec << mips->get_structural_stalls(DIVIDER) << endl;
+	cout << "Clock cycles skipped = " << dec << mips->get_skipped_cycles() << endl;
+	delete mips;
+	return stats;
+}
+
+int main(int argc, char **argv){
+
+	const char *programs[3] = {"asm/codefp.asm", "asm/codefp3.asm", "asm/divs.asm"};
+	const char *modes[2] = {"skipping enabled", "skipping enabled, steps of 5 clock cycles"};
+
+	for (unsigned p=0; p<3; p++){
+		cout << programs[p] << ", skipping disabled" << endl;
+		stats_t reference = run_program(programs[p], false, 0);
+		cout << endl;
+		for (unsigned m=0; m<2; m++){
+			cout << programs[p] << ", " << modes[m] << endl;
+			stats_t stats = run_program(programs[p], true, m ? 5 : 0);
+			bool same = stats.statistics == reference.statistics && memcmp(stats.registers, reference.registers, sizeof stats.registers) == 0;
+			cout << "Same registers and statistics as without skipping: " << (same ? "yes" : "NO") << endl << endl;
+		}
+	}
+}
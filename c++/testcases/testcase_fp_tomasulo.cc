@@ -0,0 +1,78 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the Tomasulo engine (init_tomasulo) */
+/* asm/codefp2.asm (WAR and WAW hazards), asm/codefp3.asm (long-latency divisions) and asm/codefp.asm (loop with loads, stores
+   and branches) are run on the in-order pipeline and on the Tomasulo engine, with one and with two results broadcast and
+   instructions committed per clock cycle: the final registers and data memory are the same */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* prints the integer and floating point registers, as print_registers does */
+void print_gp_registers(sim_pipe_fp *mips){
+	cout << "General purpose registers:" << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_int_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << mips->get_int_register(i) << hex << " / 0x" << mips->get_int_register(i) << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_fp_register(i)!=UNDEFINED) cout << "F" << dec << i << " = " << mips->get_fp_register(i) << hex << " / 0x" << float2unsigned(mips->get_fp_register(i)) << endl;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	const char *programs[3] = {"asm/codefp2.asm", "asm/codefp3.asm", "asm/codefp.asm"};
+	const char *modes[3] = {"IN-ORDER", "TOMASULO, CDB WIDTH 1, COMMIT WIDTH 1", "TOMASULO, CDB WIDTH 2, COMMIT WIDTH 2"};
+
+	for (unsigned p=0; p<3; p++){
+		for (unsigned m=0; m<3; m++){
+			cout << programs[p] << ", " << modes[m] << endl;
+
+			// instantiates the simulator with two units of each type (latencies of testcase_fp1-5)
+			sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 2);
+			mips->init_exec_unit(INTEGER, 0, 2);
+			mips->init_exec_unit(ADDER, 4, 2);
+			mips->init_exec_unit(MULTIPLIER, 9, 2);
+			mips->init_exec_unit(DIVIDER, 19, 2);
+			if (m != 0){
+				mips->init_tomasulo(8, m, m);
+				mips->init_reservation_stations(INTEGER, 4);
+				mips->init_reservation_stations(ADDER, 3);
+				mips->init_reservation_stations(MULTIPLIER, 2);
+				mips->init_reservation_stations(DIVIDER, 2);
+			}
+
+			mips->load_program(programs[p], 0x10000000);
+			for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,float2unsigned((float)j*10));
+			mips->set_int_register(0,0);
+			mips->set_int_register(1,0xA000);
+			mips->set_int_register(4,1);
+			for (i=1; i<12; i++) mips->set_fp_register(i, (float)i);
+			mips->run();
+
+			print_gp_registers(mips);
+			mips->print_memory(0xA000, 0xA028);
+			mips->print_memory(0xB000, 0xB028);
+			cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+			cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+			cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+			if (m != 0){
+				cout << "ROB full stalls = " << dec << mips->get_rob_full_stalls() << endl;
+				cout << "Reservation station stalls = " << dec << mips->get_reservation_station_stalls() << endl;
+				cout << "CDB stalls = " << dec << mips->get_cdb_stalls() << endl;
+				cout << "Branch flushes = " << dec << mips->get_branch_flushes() << endl;
+			}
+			cout << endl;
+			delete mips;
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the functional execution (run_functional) */
+/* The final registers and data memory are the ones printed at the end of testcase1, testcase2, testcase4 and testcase6 */
+
+/* prints the general purpose registers, as print_registers does */
+void print_gp_registers(sim_pipe *mips){
+	cout << "General purpose registers:" << endl;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++)
+		if (mips->get_gp_register(i)!=(int)UNDEFINED) cout << "R" << dec << i << " = " << mips->get_gp_register(i) << hex << " / 0x" << mips->get_gp_register(i) << endl;
+}
+
+/* executes the program functionally, and prints the registers, the data memory in the given address range, and the number of instructions executed */
+void run_program(sim_pipe *mips, unsigned start_address, unsigned end_address){
+	unsigned executed = mips->run_functional();
+
+	print_gp_registers(mips);
+	mips->print_memory(start_address, end_address);
+
+	cout << "Instructions executed functionally = " << dec << executed << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << endl;
+}
+
+int main(int argc, char **argv){
+
+	unsigned i, j;
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+
+	// testcase1 (no dependences)
+	cout << "asm/no_dep.asm" << endl;
+	mips->load_program("asm/no_dep.asm", 0x10000000);
+	for (i=0; i<7; i++) mips->set_gp_register(i,i);
+	for (i = 0x0, j=10; i<0x20; i+=4, j+=10) mips->write_memory(i,j);
+	run_program(mips, 0x0, 0x20);
+
+	// testcase2 (data dependences)
+	mips->reset();
+	cout << "asm/data_dep1.asm" << endl;
+	mips->load_program("asm/data_dep1.asm", 0x10000000);
+	for (i=0; i<7; i++) mips->set_gp_register(i,i);
+	for (i = 0x0, j=1; i<0x20; i+=4, j+=1) mips->write_memory(i,j);
+	run_program(mips, 0x0, 0x20);
+
+	// testcase4 (control dependences)
+	mips->reset();
+	cout << "asm/control_dep.asm" << endl;
+	mips->load_program("asm/control_dep.asm", 0x10000000);
+	for (i=0; i<7; i++) mips->set_gp_register(i,i);
+	for (i = 0x0, j=1; i<0x20; i+=4, j+=1) mips->write_memory(i,j);
+	run_program(mips, 0x0, 0x20);
+
+	// testcase6 (loop), executed in two steps: the second one continues where the first one stopped
+	mips->reset();
+	cout << "asm/code.asm" << endl;
+	mips->load_program("asm/code.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	cout << "Instructions executed functionally = " << dec << mips->run_functional(30) << endl;
+	cout << "Functional PC = " << hex << mips->get_functional_pc() << endl;
+	run_program(mips, 0xA000, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << "Instructions executed functionally (total) = " << dec << mips->get_functional_instructions() << endl;
+
+	delete mips;
+}
@@ -0,0 +1,102 @@
+#include "sim_pipe.h"
+#include "paged_memory.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the data memory images (load_memory_image) */
+/* A raw binary image and a sectioned image are written and loaded in data memory, and asm/code.asm (loop) sums the
+   array they initialize. Sectioned images which are not valid as a whole (wrong version or size, a section past the end
+   of the image or of the address space) are then rejected, leaving the memory unchanged - the valid sections included. */
+
+#define IMAGE "bin/testcase_memory_image.bin"
+
+/* builds a sectioned image with the given sections (address, words) */
+vector<unsigned> sectioned_image(const vector<pair<unsigned, vector<unsigned> > > &sections){
+	vector<unsigned> image = {MEMORY_IMAGE_MAGIC, MEMORY_IMAGE_VERSION, 0, (unsigned) sections.size()};
+	for (unsigned s=0; s<sections.size(); s++){
+		image.push_back(sections[s].first);
+		image.push_back(sections[s].second.size() * sizeof(unsigned));
+		image.insert(image.end(), sections[s].second.begin(), sections[s].second.end());
+	}
+	image[2] = image.size() * sizeof(unsigned);
+	return image;
+}
+
+/* writes the image in file IMAGE */
+void write_image(const vector<unsigned> &image){
+	ofstream fout(IMAGE, ios::binary);
+	fout.write((const char *) image.data(), image.size() * sizeof(unsigned));
+}
+
+/* runs asm/code.asm, with the array initialized by the image, and prints the final data memory and statistics */
+void run_program(unsigned base_address){
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+	mips->load_program("asm/code.asm", 0x10000000);
+	mips->load_memory_image(IMAGE, base_address);
+	mips->print_memory(0xA000, 0xA028);
+	mips->run();
+	mips->print_memory(0xA020, 0xA028);
+	mips->print_memory(0xB000, 0xB028);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+	cout << endl;
+	delete mips;
+}
+
+/* loads the image in a memory holding 0x12345678 at 0xA000, and prints whether it has been accepted and the word at 0xA000 */
+void check_image(const char *description, const vector<unsigned> &image){
+	write_image(image);
+	paged_memory memory;
+	memory.write_word(0xA000, 0x12345678);
+	bool ok = memory.load_image(IMAGE, 0xA000);
+	cout << description << ": " << (ok ? "accepted" : "rejected") << hex << ", 0xA000 = 0x" << memory.read_word(0xA000) << dec << endl;
+}
+
+int main(int argc, char **argv){
+
+	// raw image: the words 1..8 at 0xA000 (as in testcase6)
+	cout << "RAW IMAGE" << endl;
+	write_image({1, 2, 3, 4, 5, 6, 7, 8});
+	run_program(0xA000);
+
+	// sectioned image: two sections (the second one with a negative value), relative to 0xA000
+	vector<pair<unsigned, vector<unsigned> > > sections = {{0x0, {1, 2, 3, 4}}, {0x10, {5, (unsigned) -6, 7, 8}}};
+	vector<unsigned> image = sectioned_image(sections);
+	cout << "SECTIONED IMAGE" << endl;
+	write_image(image);
+	run_program(0xA000);
+
+	vector<unsigned> corrupted;
+
+	check_image("Valid image", image);
+
+	corrupted = image;
+	corrupted[1] = MEMORY_IMAGE_VERSION + 1;
+	check_image("Wrong version", corrupted);
+
+	corrupted = image;
+	corrupted[2] += sizeof(unsigned);
+	check_image("Wrong size", corrupted);
+
+	corrupted = image;
+	corrupted.pop_back();
+	corrupted[2] = corrupted.size() * sizeof(unsigned);
+	check_image("Truncated last section", corrupted);
+
+	corrupted = image;
+	corrupted[3] += 1;
+	check_image("Missing section", corrupted);
+
+	corrupted = sectioned_image({sections[0], {0xFFFFFFF8 - 0xA000, {1, 2, 3}}});
+	check_image("Section past the end of the address space", corrupted);
+
+	corrupted = sectioned_image({sections[0], {0xFFFFFFF4 - 0xA000, {1, 2, 3}}});
+	check_image("Section at the end of the address space", corrupted);
+
+	remove(IMAGE);
+}
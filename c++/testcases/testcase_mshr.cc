@@ -0,0 +1,62 @@
+#include "sim_pipe_fp.h"
+#include <iostream>
+#include <cstring>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the non-blocking L1 cache (init_mshrs) */
+/* asm/mlp.asm issues six independent loads to four lines (two pairs of loads to the same line) and sums the values loaded.
+   The Tomasulo engine overlaps the misses up to the number of MSHRs, and the second load to a line is merged into the
+   MSHR of the first one; the in-order pipeline, which stalls in MEM until each access completes, is shown for comparison. */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* runs asm/mlp.asm with a 20 clock cycles data memory and a 1KB L1 cache with "num_mshrs" MSHRs, and prints the result and statistics */
+void run_program(bool tomasulo, unsigned num_mshrs){
+	sim_pipe_fp *mips = new sim_pipe_fp(1024*1024, 20);
+	mips->init_exec_unit(INTEGER, 1, 1);
+	mips->init_exec_unit(ADDER, 2, 2);
+	mips->init_exec_unit(MULTIPLIER, 4, 1);
+	mips->init_exec_unit(DIVIDER, 8, 1);
+	if (tomasulo){
+		mips->init_tomasulo(16);
+		mips->init_reservation_stations(INTEGER, 8);
+		mips->init_reservation_stations(ADDER, 4);
+		mips->init_reservation_stations(MULTIPLIER, 1);
+		mips->init_reservation_stations(DIVIDER, 1);
+	}
+	mips->init_cache(CACHE_L1, 1024, 2, 16, 1);
+	mips->init_mshrs(num_mshrs);
+
+	mips->load_program("asm/mlp.asm", 0x10000000);
+	for (unsigned i = 0xA000; i<0xA100; i+=4) mips->write_memory(i,float2unsigned((float)(i-0xA000)/4));
+	mips->run();
+
+	mips->print_memory(0xA100, 0xA104);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "L1: hits = " << dec << mips->get_cache_hits(CACHE_L1) << ", misses = " << mips->get_cache_misses(CACHE_L1) << endl;
+	cout << "Merged misses = " << dec << mips->get_merged_misses() << endl;
+	cout << "MSHR full stalls = " << dec << mips->get_mshr_full_stalls() << endl;
+	cout << "Memory-level parallelism = " << mips->get_memory_level_parallelism() << endl;
+	cout << endl;
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	cout << "IN-ORDER PIPELINE, 4 MSHRs" << endl;
+	run_program(false, 4);
+
+	cout << "TOMASULO, 1 MSHR" << endl;
+	run_program(true, 1);
+
+	cout << "TOMASULO, 4 MSHRs" << endl;
+	run_program(true, 4);
+}
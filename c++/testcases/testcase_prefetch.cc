@@ -0,0 +1,46 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the stride prefetcher (init_prefetcher) */
+/* asm/stride.asm sums 16 words 32 bytes apart (one every other 16B line, so that next-line prefetching would not help),
+   with a 20 clock cycles data memory and a 1KB L1 cache: without a prefetcher every load misses, while the stride
+   prefetcher learns the stride after the first loads, and a higher degree prefetches far enough ahead to hide more latency */
+
+/* runs asm/stride.asm with a prefetcher of the given degree (0: no prefetcher), and prints the result and statistics */
+void run_program(unsigned degree){
+	sim_pipe *mips = new sim_pipe(1024*1024, 20);
+	mips->init_cache(CACHE_L1, 1024, 2, 16, 1);
+	if (degree != 0) mips->init_prefetcher(16, degree);
+
+	mips->load_program("asm/stride.asm", 0x10000000);
+	for (unsigned i = 0xA000, j=1; i<0xA200; i+=32, j+=1) mips->write_memory(i,j);
+	mips->run();
+
+	mips->print_memory(0xA200, 0xA204);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "L1: hits = " << dec << mips->get_cache_hits(CACHE_L1) << ", misses = " << mips->get_cache_misses(CACHE_L1) << endl;
+	if (degree != 0){
+		cout << "Prefetch accuracy = " << mips->get_prefetch_accuracy() << endl;
+		cout << "Prefetch coverage = " << mips->get_prefetch_coverage() << endl;
+		cout << "Prefetch timeliness = " << mips->get_prefetch_timeliness() << endl;
+	}
+	cout << endl;
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	cout << "NO PREFETCHER" << endl;
+	run_program(0);
+
+	cout << "STRIDE PREFETCHER, DEGREE 1" << endl;
+	run_program(1);
+
+	cout << "STRIDE PREFETCHER, DEGREE 2" << endl;
+	run_program(2);
+}
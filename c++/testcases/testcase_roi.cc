@@ -0,0 +1,55 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the region of interest (run_roi) */
+/* asm/roi.asm initializes an array (fast-forwarded), sums it (region of interest: 3+8*5 = 43 instructions), and stores the sum (executed functionally) */
+/* in asm/roi_exit.asm, a branch leaves the region of interest for the EOP at the end of the program: the instruction after .roi_end is never executed */
+
+int main(int argc, char **argv){
+
+	// instantiates the simulator with a 1MB data memory
+	sim_pipe *mips = new sim_pipe(1024*1024, 2);
+
+	//loads program in instruction memory at address 0x10000000
+	mips->load_program("asm/roi.asm", 0x10000000);
+
+	// runs the program, simulating only its region of interest in detail
+	cout << "RUNNING THE REGION OF INTEREST..." << endl << endl;
+	mips->run_roi();
+
+	//prints the value of registers and data memory
+	mips->print_registers();
+	mips->print_memory(0xA000, 0xA024);
+
+	cout << endl;
+
+	// prints the number of instructions executed and IPC (region of interest only)
+	cout << "Instructions executed functionally = " << dec << mips->get_functional_instructions() << endl;
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+
+	// the whole program simulated in detail, for comparison
+	cout << endl << "RUNNING THE WHOLE PROGRAM..." << endl << endl;
+	mips->reset();
+	mips->load_program("asm/roi.asm", 0x10000000);
+	mips->run();
+	mips->print_memory(0xA020, 0xA024);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+
+	cout << endl << "RUNNING THE REGION OF INTEREST OF asm/roi_exit.asm..." << endl << endl;
+	mips->reset();
+	mips->load_program("asm/roi_exit.asm", 0x10000000);
+	mips->run_roi();
+	mips->print_registers();
+	cout << "Instructions executed functionally = " << dec << mips->get_functional_instructions() << endl;
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+
+	delete mips;
+}
@@ -0,0 +1,67 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the skipping of idle clock cycles (init_cycle_skipping) */
+/* asm/code.asm is run with a 20 clock cycles data memory, with the skipping disabled, enabled, and enabled with the
+   simulation advanced in steps of 7 clock cycles (the skipping stops at the end of each step): the final data memory
+   and statistics have to be the same, only the number of clock cycles skipped changes */
+
+typedef struct{
+	unsigned clock_cycles;
+	unsigned stalls;
+	unsigned instructions_executed;
+	unsigned result;
+} stats_t;
+
+/* runs asm/code.asm (in steps of "step" clock cycles, if not 0), and returns and prints the final statistics */
+stats_t run_program(bool skipping, unsigned step){
+	unsigned i, j;
+
+	sim_pipe *mips = new sim_pipe(1024*1024, 20);
+	mips->init_cycle_skipping(skipping);
+
+	mips->load_program("asm/code.asm", 0x10000000);
+	for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	if (step == 0) mips->run();
+	else {
+		// run(step) returns early once the program has completed
+		unsigned start_cycles;
+		do {
+			start_cycles = mips->get_clock_cycles();
+			mips->run(step);
+		} while (mips->get_clock_cycles() - start_cycles == step);
+	}
+
+	stats_t stats;
+	stats.clock_cycles = mips->get_clock_cycles();
+	stats.stalls = mips->get_stalls();
+	stats.instructions_executed = mips->get_instructions_executed();
+	stats.result = mips->read_memory(0xA020);
+
+	mips->print_memory(0xA020, 0xA028);
+	cout << "Instruction executed = " << dec << stats.instructions_executed << endl;
+	cout << "Clock cycles = " << dec << stats.clock_cycles << endl;
+	cout << "Stall inserted = " << dec << stats.stalls << endl;
+	cout << "Clock cycles skipped = " << dec << mips->get_skipped_cycles() << endl;
+	cout << endl;
+	delete mips;
+	return stats;
+}
+
+int main(int argc, char **argv){
+
+	cout << "SKIPPING DISABLED" << endl;
+	stats_t reference = run_program(false, 0);
+
+	const char *modes[2] = {"SKIPPING ENABLED", "SKIPPING ENABLED, STEPS OF 7 CLOCK CYCLES"};
+	for (unsigned m=0; m<2; m++){
+		cout << modes[m] << endl;
+		stats_t stats = run_program(true, m ? 7 : 0);
+		bool same = stats.clock_cycles == reference.clock_cycles && stats.stalls == reference.stalls &&
+			stats.instructions_executed == reference.instructions_executed && stats.result == reference.result;
+		cout << "Same statistics as without skipping: " << (same ? "yes" : "NO") << endl << endl;
+	}
+}
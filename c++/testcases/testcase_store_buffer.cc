@@ -0,0 +1,41 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the store buffer (init_store_buffer) */
+/* asm/store_load.asm increments each word of an array, and reads it back right after storing it, with a 20 clock cycles
+   data memory: with a store buffer the stores complete without waiting for the memory, and the loads which read the word
+   just stored get its value forwarded from the store buffer; a store buffer with a single entry fills up */
+
+/* runs asm/store_load.asm with a store buffer of "num_entries" entries (0: no store buffer), and prints the data memory and statistics */
+void run_program(unsigned num_entries){
+	sim_pipe *mips = new sim_pipe(1024*1024, 20);
+	if (num_entries != 0) mips->init_store_buffer(num_entries);
+
+	mips->load_program("asm/store_load.asm", 0x10000000);
+	for (unsigned i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	mips->run();
+
+	mips->print_memory(0xA000, 0xA024);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec  << mips->get_stalls() << endl;
+	cout << "Forwarded loads = " << dec << mips->get_forwarded_loads() << endl;
+	cout << "Store buffer full stalls = " << dec << mips->get_store_buffer_full_stalls() << endl;
+	cout << endl;
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	cout << "NO STORE BUFFER" << endl;
+	run_program(0);
+
+	cout << "STORE BUFFER, 1 ENTRY" << endl;
+	run_program(1);
+
+	cout << "STORE BUFFER, 4 ENTRIES" << endl;
+	run_program(4);
+}
@@ -0,0 +1,63 @@
+#include "sim_pipe.h"
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+
+/* Test case for the superscalar mode (init_superscalar) */
+/* asm/no_dep.asm has no dependences between its instructions, so that they can be fetched in groups which are limited
+   only by the data memory ports; asm/code.asm (loop) has dependences, which split some of the groups. With full forwarding
+   and a branch predictor, both programs complete with more than one instruction per clock cycle on a 2-wide and a 4-wide
+   pipeline. The final registers and data memory are the same as in scalar mode. */
+
+/* runs the program (initialized as in testcase1, or as in testcase6 if "loop") with the given issue width (1: scalar), and prints the final registers, data memory and statistics */
+void run_program(const char *program, bool loop, unsigned issue_width, unsigned memory_ports){
+	unsigned i, j;
+
+	sim_pipe *mips = new sim_pipe(1024*1024, 0);
+	mips->init_forwarding(FULL_FORWARDING);
+	mips->init_branch_predictor(PREDICT_BIMODAL, 16);
+	if (issue_width > 1) mips->init_superscalar(issue_width, 0, memory_ports);
+
+	mips->load_program(program, 0x10000000);
+	if (loop){
+		for (i = 0xA000, j=1; i<0xA020; i+=4, j+=1) mips->write_memory(i,j);
+	} else {
+		for (i=0; i<7; i++) mips->set_gp_register(i,i);
+		for (i = 0x0, j=10; i<0x20; i+=4, j+=10) mips->write_memory(i,j);
+	}
+	mips->run();
+
+	mips->print_registers();
+	if (loop){
+		mips->print_memory(0xA020, 0xA028);
+		mips->print_memory(0xB000, 0xB028);
+	} else mips->print_memory(0x0, 0x8);
+	cout << "Instruction executed = " << dec << mips->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << mips->get_clock_cycles() << endl;
+	cout << "Stall inserted = " << dec << mips->get_stalls() << endl;
+	cout << "IPC = " << dec << mips->get_IPC() << endl;
+	cout << "Groups split by a dependence = " << dec << mips->get_group_splits(SPLIT_DEPENDENCY) << endl;
+	cout << "Groups split by the memory ports = " << dec << mips->get_group_splits(SPLIT_MEMORY_PORT) << endl;
+	cout << "Groups split by a branch = " << dec << mips->get_group_splits(SPLIT_BRANCH) << endl;
+	cout << endl;
+	delete mips;
+}
+
+int main(int argc, char **argv){
+
+	const char *programs[2] = {"asm/no_dep.asm", "asm/code.asm"};
+
+	for (unsigned p=0; p<2; p++){
+		cout << programs[p] << endl << endl;
+
+		cout << "SCALAR" << endl;
+		run_program(programs[p], p == 1, 1, 1);
+
+		cout << "2-WIDE, 1 MEMORY PORT" << endl;
+		run_program(programs[p], p == 1, 2, 1);
+
+		cout << "4-WIDE, 2 MEMORY PORTS" << endl;
+		run_program(programs[p], p == 1, 4, 2);
+	}
+}